@@ -0,0 +1,206 @@
+/**
+ * wordfile-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements WordFile, a memory-mapped file of words (kept inline, so that
+ * each spell checker only has to include the header)
+ *
+ * Part of CS70 Homeworks 6, 7 and 8. This file may NOT be shared with
+ * anyone other than the author(s) and the current semester's CS70 staff
+ * without explicit written permission from one of the CS70 instructors.
+ */
+
+#ifndef WORDFILE_HPP_INCLUDED
+#warning "Don't include this file directly. Include wordfile.hpp instead."
+#endif
+
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+inline WordFile::WordFile(const std::string& filename)
+    : data_{nullptr}, size_{0}, mapped_{false}, buffer_{} {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Error reading '" + filename + "'");
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "Error reading '" + filename + "'");
+    }
+    if (S_ISREG(info.st_mode)) {
+        size_ = size_t(info.st_size);
+        // an empty file has nothing to map (and mmap would refuse it)
+        if (size_ > 0) {
+            void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(),
+                                        "Error mapping '" + filename + "'");
+            }
+            // we read front to back, so the kernel can read well ahead
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(mapping);
+            mapped_ = true;
+        }
+    } else {
+        // pipes and terminals can't be mapped, so read them in instead
+        constexpr size_t CHUNK_SIZE = 65536;
+        char chunk[CHUNK_SIZE];
+        ssize_t bytesRead;
+        while ((bytesRead = read(fd, chunk, CHUNK_SIZE)) != 0) {
+            if (bytesRead < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(),
+                                        "Error reading '" + filename + "'");
+            }
+            buffer_.append(chunk, size_t(bytesRead));
+        }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+    close(fd);
+}
+
+inline WordFile::~WordFile() {
+    if (mapped_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+inline WordFile::const_iterator WordFile::begin() const {
+    return const_iterator{data_, data_ + size_};
+}
+
+inline WordFile::const_iterator WordFile::end() const {
+    return const_iterator{data_ + size_, data_ + size_};
+}
+
+inline std::string_view WordFile::contents() const {
+    return std::string_view{data_, size_};
+}
+
+inline bool WordFile::isSpace(char c) {
+    // '\t' through '\r' are consecutive, so one unsigned comparison does
+    return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+#ifdef __SSE2__
+
+inline uint32_t WordFile::spaceMask(const char* next) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(next));
+    __m128i isBlank = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+    // x - '\t' is at most '\r' - '\t' (unsigned) exactly when the unsigned
+    // minimum of the two is x - '\t' itself
+    __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+    __m128i isControl = _mm_cmpeq_epi8(
+        _mm_min_epu8(offset, _mm_set1_epi8('\r' - '\t')), offset);
+    return uint32_t(_mm_movemask_epi8(_mm_or_si128(isBlank, isControl)));
+}
+
+inline const char* WordFile::skipSpace(const char* next, const char* end) {
+    while (end - next >= 16) {
+        uint32_t notSpace = ~spaceMask(next) & 0xFFFF;
+        if (notSpace != 0) {
+            return next + __builtin_ctz(notSpace);
+        }
+        next += 16;
+    }
+    // fewer than 16 bytes left, so one at a time (never reading past end)
+    while (next != end && isSpace(*next)) {
+        ++next;
+    }
+    return next;
+}
+
+inline const char* WordFile::findSpace(const char* next, const char* end) {
+    while (end - next >= 16) {
+        uint32_t space = spaceMask(next);
+        if (space != 0) {
+            return next + __builtin_ctz(space);
+        }
+        next += 16;
+    }
+    while (next != end && !isSpace(*next)) {
+        ++next;
+    }
+    return next;
+}
+
+#else
+
+inline const char* WordFile::skipSpace(const char* next, const char* end) {
+    while (next != end && isSpace(*next)) {
+        ++next;
+    }
+    return next;
+}
+
+inline const char* WordFile::findSpace(const char* next, const char* end) {
+    while (next != end && !isSpace(*next)) {
+        ++next;
+    }
+    return next;
+}
+
+#endif  // __SSE2__
+
+inline WordFile::const_iterator::const_iterator(const char* next,
+                                                const char* end)
+    : word_{}, end_{end} {
+    next = skipSpace(next, end);
+    word_ = std::string_view{next, size_t(findSpace(next, end) - next)};
+}
+
+inline WordFile::const_iterator::reference
+WordFile::const_iterator::operator*() const {
+    return word_;
+}
+
+inline WordFile::const_iterator::pointer
+WordFile::const_iterator::operator->() const {
+    return &word_;
+}
+
+inline WordFile::const_iterator& WordFile::const_iterator::operator++() {
+    *this = const_iterator{word_.data() + word_.size(), end_};
+    return *this;
+}
+
+inline WordFile::const_iterator WordFile::const_iterator::operator++(int) {
+    const_iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+inline bool WordFile::const_iterator::operator==(
+    const const_iterator& other) const {
+    // the end iterator's empty word sits at the end of the file
+    return word_.data() == other.word_.data();
+}
+
+inline bool WordFile::const_iterator::operator!=(
+    const const_iterator& other) const {
+    return !(*this == other);
+}
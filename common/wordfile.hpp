@@ -0,0 +1,117 @@
+/**
+ * wordfile.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides WordFile, a read-only view of a file's words for the spell
+ * checkers (minispell in homeworks 6, 7 and 8).  The file is mapped into
+ * memory (mmap) rather than read through a stream, and iterating over a
+ * WordFile yields each whitespace-separated word as a std::string_view into
+ * the mapping, so no word is copied or allocated unless the caller wants a
+ * std::string of its own.
+ *
+ * Words are split on the same whitespace as `std::cin >> word` (space, tab,
+ * newline, vertical tab, form feed and carriage return).  Where SSE2 is
+ * available the scanner tests 16 bytes at a time.
+ *
+ * Files that can't be mapped (pipes, terminals) are read into memory
+ * instead, so a WordFile works on anything open() accepts.
+ *
+ * Part of CS70 Homeworks 6, 7 and 8. This file may NOT be shared with
+ * anyone other than the author(s) and the current semester's CS70 staff
+ * without explicit written permission from one of the CS70 instructors.
+ */
+
+#ifndef WORDFILE_HPP_INCLUDED
+#define WORDFILE_HPP_INCLUDED
+
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+class WordFile {
+ public:
+    /* \brief Iterates over the words of a WordFile, front to back
+     */
+    class const_iterator {
+     public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        const_iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+     private:
+        friend class WordFile;
+
+        /* \brief Starts at the first word at or after next
+         */
+        const_iterator(const char* next, const char* end);
+
+        std::string_view word_;      // the current word (empty at the end)
+        const char* end_ = nullptr;  // just past the last byte of the file
+    };
+
+    /* \brief Opens a file and maps it into memory
+     * \param the name of the file
+     * \throws std::system_error if the file can't be opened or read
+     */
+    explicit WordFile(const std::string& filename);
+
+    WordFile(const WordFile& other) = delete;
+    WordFile& operator=(const WordFile& other) = delete;
+
+    /* \brief Destructor; unmaps the file, so no word may be used after
+     */
+    ~WordFile();
+
+    /* \brief Iterators over the words of the file
+     */
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /* \brief Returns the whole file
+     */
+    std::string_view contents() const;
+
+    /* \brief Returns the first byte in [next, end) that isn't whitespace, or
+     *        end if there is none
+     */
+    static const char* skipSpace(const char* next, const char* end);
+
+    /* \brief Returns the first byte in [next, end) that is whitespace, or
+     *        end if there is none
+     */
+    static const char* findSpace(const char* next, const char* end);
+
+    /* \brief Returns whether a byte is whitespace (as `>>` sees it)
+     */
+    static bool isSpace(char c);
+
+ private:
+    /* \brief Returns a bitmask with bit i set if byte i of the 16 bytes at
+     *        next is whitespace
+     */
+    static uint32_t spaceMask(const char* next);
+
+    const char* data_;    // the start of the file's bytes
+    size_t size_;         // Number of bytes in the file
+    bool mapped_;         // whether data_ is a mapping (or buffer_ instead)
+    std::string buffer_;  // the bytes of a file that couldn't be mapped
+};
+
+#include "wordfile-private.hpp"
+
+#endif  // WORDFILE_HPP_INCLUDED
@@ -0,0 +1,137 @@
+/**
+ * wordstream-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements WordStream, a double-buffered reader of a file's words (kept
+ * inline, like WordFile)
+ *
+ * Part of CS70 Homeworks 6, 7 and 8. This file may NOT be shared with
+ * anyone other than the author(s) and the current semester's CS70 staff
+ * without explicit written permission from one of the CS70 instructors.
+ */
+
+#ifndef WORDSTREAM_HPP_INCLUDED
+#warning "Don't include this file directly. Include wordstream.hpp instead."
+#endif
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <cerrno>
+#include <cstddef>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+inline WordStream::WordStream(const std::string& filename, size_t chunkSize)
+    : fd_{STDIN_FILENO},
+      ownsFd_{false},
+      chunkSize_{std::max(chunkSize, size_t(1))},
+      buffers_{std::vector<char>(chunkSize_), std::vector<char>(chunkSize_)},
+      current_{1},
+      pending_{},
+      atEnd_{false},
+      partial_{},
+      joined_{},
+      filename_{filename} {
+    if (filename != "-") {
+        fd_ = open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Error reading '" + filename + "'");
+        }
+        ownsFd_ = true;
+    }
+    startReading(0);
+}
+
+inline WordStream::~WordStream() {
+    // the reader must be done with the file (and buffer) before we go
+    if (pending_.valid()) {
+        pending_.wait();
+    }
+    if (ownsFd_) {
+        close(fd_);
+    }
+}
+
+inline size_t WordStream::chunkSize() const {
+    return chunkSize_;
+}
+
+inline void WordStream::startReading(size_t buffer) {
+    pending_ = std::async(std::launch::async,
+                          [this, buffer] { return readChunk(buffer); });
+}
+
+inline size_t WordStream::readChunk(size_t buffer) {
+    while (true) {
+        ssize_t bytesRead = read(fd_, buffers_[buffer].data(), chunkSize_);
+        if (bytesRead >= 0) {
+            return size_t(bytesRead);
+        } else if (errno != EINTR) {
+            throw std::system_error(errno, std::generic_category(),
+                                    "Error reading '" + filename_ + "'");
+        }
+    }
+}
+
+inline bool WordStream::nextChunk(std::vector<std::string_view>& words) {
+    words.clear();
+    while (!atEnd_) {
+        // rethrows anything the read threw
+        size_t bytes = pending_.get();
+        current_ = 1 - current_;
+        if (bytes == 0) {
+            atEnd_ = true;
+            // the last word had nothing after it
+            if (!partial_.empty()) {
+                joined_.swap(partial_);
+                partial_.clear();
+                words.push_back(joined_);
+            }
+            break;
+        }
+        // the caller is done with the other buffer, so read the next chunk
+        // into it while we split this one up
+        startReading(1 - current_);
+        const char* next = buffers_[current_].data();
+        const char* end = next + bytes;
+
+        // finish off a word the last chunk cut short
+        if (!partial_.empty()) {
+            const char* wordEnd = WordFile::findSpace(next, end);
+            partial_.append(next, wordEnd);
+            if (wordEnd == end) {
+                continue;
+            }
+            joined_.swap(partial_);
+            partial_.clear();
+            words.push_back(joined_);
+            next = wordEnd;
+        }
+
+        while (true) {
+            next = WordFile::skipSpace(next, end);
+            if (next == end) {
+                break;
+            }
+            const char* wordEnd = WordFile::findSpace(next, end);
+            if (wordEnd == end) {
+                // the word may go on in the next chunk, and this buffer
+                // will be reused, so keep a copy
+                partial_.assign(next, end);
+                break;
+            }
+            words.emplace_back(next, size_t(wordEnd - next));
+            next = wordEnd;
+        }
+        if (!words.empty()) {
+            return true;
+        }
+    }
+    return !words.empty();
+}
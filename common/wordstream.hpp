@@ -0,0 +1,91 @@
+/**
+ * wordstream.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides WordStream, which reads the words of a file (or of standard
+ * input) a chunk at a time, so a spell checker can check input of any size
+ * in a fixed amount of memory.  Each call to nextChunk hands back the whole
+ * words of the next chunk as std::string_views, and a word that straddles
+ * two chunks is joined up before it is handed back.
+ *
+ * Reading is double-buffered: while the caller works on one chunk, a
+ * background thread is already reading the next one into the other buffer,
+ * so reading the input overlaps with whatever the caller does with it.
+ * Words are split on the same whitespace as WordFile.
+ *
+ * Part of CS70 Homeworks 6, 7 and 8. This file may NOT be shared with
+ * anyone other than the author(s) and the current semester's CS70 staff
+ * without explicit written permission from one of the CS70 instructors.
+ */
+
+#ifndef WORDSTREAM_HPP_INCLUDED
+#define WORDSTREAM_HPP_INCLUDED
+
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+#include "wordfile.hpp"
+
+class WordStream {
+ public:
+    /* \brief Number of bytes read at a time when the client doesn't pick
+     */
+    static constexpr size_t DEFAULT_CHUNK_SIZE = size_t(1) << 20;
+
+    /* \brief Opens a file and starts reading its first chunk
+     * \param the name of the file ("-" for standard input), and how many
+     *        bytes to read at a time
+     * \throws std::system_error if the file can't be opened
+     */
+    explicit WordStream(const std::string& filename,
+                        size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    WordStream(const WordStream& other) = delete;
+    WordStream& operator=(const WordStream& other) = delete;
+
+    /* \brief Destructor; waits for any read in progress, then closes the
+     *        file (unless it is standard input)
+     */
+    ~WordStream();
+
+    /* \brief Replaces the contents of a vector with the words of the next
+     *        chunk (waiting for it to be read if need be)
+     * \param the vector to fill; its views are valid until the next call
+     * \returns false once there are no words left
+     * \throws std::system_error if reading fails
+     */
+    bool nextChunk(std::vector<std::string_view>& words);
+
+    /* \brief Returns the number of bytes read at a time
+     */
+    size_t chunkSize() const;
+
+ private:
+    /* \brief Starts reading into a buffer in the background
+     */
+    void startReading(size_t buffer);
+
+    /* \brief Reads up to one chunk into a buffer, returning the number of
+     *        bytes read (zero at the end of the file)
+     */
+    size_t readChunk(size_t buffer);
+
+    int fd_;                        // the file being read
+    bool ownsFd_;                   // whether to close fd_ (not stdin)
+    size_t chunkSize_;              // Number of bytes read at a time
+    std::vector<char> buffers_[2];  // one being read, one being split up
+    size_t current_;                // the buffer the caller's words are in
+    std::future<size_t> pending_;   // the read in progress, if any
+    bool atEnd_;                    // whether the whole file has been read
+    std::string partial_;           // a word cut off by the end of a chunk
+    std::string joined_;            // the last one joined up, to hand back
+    std::string filename_;          // the file's name, for error messages
+};
+
+#include "wordstream-private.hpp"
+
+#endif  // WORDSTREAM_HPP_INCLUDED
@@ -1,13 +1,11 @@
 #include "treestringset.hpp"
+#include "wordfile.hpp"
 #include <iostream>
-#include <fstream>
 #include <vector>
 #include <list>
 #include <algorithm>
 #include <stdexcept>
-#include <system_error>
 #include <limits>
-#include <cerrno>
 #include <chrono>
 #include <random>
 #include <cstddef>
@@ -21,27 +19,13 @@
 void readWords(std::vector<std::string>& words, std::string filename,
                size_t maxwords) {
     std::cerr << "Reading words from " << filename << "...";
-    try {
-        std::ifstream in;
-        in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        in.open(filename);
-        in.exceptions(std::ifstream::badbit);
-        std::string word;
-        for (size_t i = 0; i < maxwords; ++i) {
-            in >> word;
-            if (!in.good()) {
-                break;
-            }
-            words.push_back(word);
-        }
-        std::cerr << " done!\n";
-    } catch (std::system_error& e) {
-        // The error exceptions thrown by our standard library aren't very
-        // meaningful, so we catch them and rethrow them with more information.
-        throw std::system_error(
-            std::make_error_code(std::errc(errno)),
-            "Error reading '" + filename + "' (" + e.code().message() + +")");
+    WordFile file{filename};
+    size_t count = 0;
+    for (auto word = file.begin(); word != file.end() && count < maxwords;
+         ++word, ++count) {
+        words.emplace_back(*word);
     }
+    std::cerr << " done!\n";
 }
 
 /**
@@ -0,0 +1,239 @@
+/**
+ * arenatable-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements ArenaTable<std::string>, the interned-string layout for HashSet
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef ARENATABLE_HPP_INCLUDED
+#warning "Don't include this file directly. Include arenatable.hpp instead."
+#endif
+
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <cstddef>
+
+template <typename T>
+ArenaTable<T>::ArenaTable(size_t numBuckets)
+    : slots_{nullptr},
+      numSlots_{2},
+      shift_{0},
+      arena_{},
+      size_{0},
+      vacated_{0},
+      deadBytes_{0} {
+    // round up to a power of two (at least two, so the shift stays in range)
+    while (numSlots_ < numBuckets) {
+        numSlots_ *= 2;
+    }
+    size_t bits = 0;
+    while ((size_t(1) << bits) < numSlots_) {
+        ++bits;
+    }
+    shift_ = std::numeric_limits<size_t>::digits - bits;
+    slots_ = new Slot[numSlots_];
+}
+
+template <typename T>
+ArenaTable<T>::~ArenaTable() {
+    // slots hold no objects of their own; arena_ frees the bytes
+    delete[] slots_;
+}
+
+template <typename T>
+void ArenaTable<T>::swap(ArenaTable<T>& other) {
+    using std::swap;
+    swap(slots_, other.slots_);
+    swap(numSlots_, other.numSlots_);
+    swap(shift_, other.shift_);
+    arena_.swap(other.arena_);
+    swap(size_, other.size_);
+    swap(vacated_, other.vacated_);
+    swap(deadBytes_, other.deadBytes_);
+}
+
+template <typename T>
+size_t ArenaTable<T>::buckets() const {
+    return numSlots_;
+}
+
+template <typename T>
+std::string_view ArenaTable<T>::word(const Slot& slot) const {
+    return std::string_view{arena_.data() + slot.offset, slot.length};
+}
+
+template <typename T>
+size_t ArenaTable<T>::home(size_t hash) const {
+    // 2^64 / golden ratio
+    constexpr size_t FIBONACCI_MULTIPLIER = size_t(0x9E3779B97F4A7C15ULL);
+    return (hash * FIBONACCI_MULTIPLIER) >> shift_;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool ArenaTable<T>::contains(size_t hash, const K& key, const KeyEqual& equal,
+                             size_t& steps) const {
+    steps = 0;
+    // vacated slots don't end the search; only a never-used one does (or
+    // running out of slots, since an old table being drained by an
+    // incremental rehash can be entirely full)
+    for (size_t pos = home(hash);
+         slots_[pos].length != EMPTY && steps < numSlots_;
+         pos = (pos + 1) & (numSlots_ - 1)) {
+        ++steps;
+        // only compare the bytes themselves if the full hashes agree
+        const Slot& slot = slots_[pos];
+        if (slot.hash == hash && slot.length != VACATED
+            && equal(word(slot), key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void ArenaTable<T>::prefetch(size_t hash) const {
+    prefetchForRead(&slots_[home(hash)]);
+}
+
+template <typename T>
+template <typename... Args>
+bool ArenaTable<T>::emplaceNew(size_t hash, Args&&... args) {
+    std::string_view key{std::forward<Args>(args)...};
+    if (key.size() >= VACATED
+        || arena_.size() + key.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("ArenaTable arena is full");
+    }
+    // (key can't point into our own arena: strings only ever arrive from
+    // outside the table)
+    if (needsRebuild()) {
+        rebuild();
+    }
+    size_t pos = home(hash);
+    bool collided = slots_[pos].length != EMPTY;
+    while (slots_[pos].length != EMPTY && slots_[pos].length != VACATED) {
+        pos = (pos + 1) & (numSlots_ - 1);
+    }
+    if (slots_[pos].length == VACATED) {
+        --vacated_;
+    }
+    ++size_;
+    slots_[pos].hash = hash;
+    slots_[pos].offset = uint32_t(arena_.size());
+    slots_[pos].length = uint32_t(key.size());
+    arena_.insert(arena_.end(), key.begin(), key.end());
+    return collided;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool ArenaTable<T>::erase(size_t hash, const K& key, const KeyEqual& equal) {
+    size_t steps = 0;
+    for (size_t pos = home(hash);
+         slots_[pos].length != EMPTY && steps < numSlots_;
+         pos = (pos + 1) & (numSlots_ - 1)) {
+        ++steps;
+        Slot& slot = slots_[pos];
+        if (slot.hash == hash && slot.length != VACATED
+            && equal(word(slot), key)) {
+            // later strings may have probed past this slot, so it can't
+            // simply be emptied
+            deadBytes_ += slot.length;
+            slot.length = VACATED;
+            --size_;
+            ++vacated_;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+size_t ArenaTable<T>::transferBucket(size_t bucket, ArenaTable<T>& dest) {
+    Slot& source = slots_[bucket];
+    if (source.length == EMPTY || source.length == VACATED) {
+        return 0;
+    }
+    // the cached hash means we never need to call myhash again
+    dest.emplaceNew(source.hash, word(source));
+    deadBytes_ += source.length;
+    source.length = VACATED;
+    --size_;
+    ++vacated_;
+    return 1;
+}
+
+template <typename T>
+bool ArenaTable<T>::needsRebuild() const {
+    // Vacated slots lengthen every search that passes them, and nothing
+    // else turns them back into empty ones; but a few are harmless while
+    // the table is no fuller than its default load.  Each rebuild gets rid
+    // of at least numSlots_ / VACATED_DIVISOR of them (or half the arena),
+    // so its cost is spread over that many erases.
+    bool crowded = size_ + vacated_ + 1 > numSlots_ * DEFAULT_MAX_LOAD_FACTOR
+                   && vacated_ >= numSlots_ / VACATED_DIVISOR;
+    return crowded || deadBytes_ > arena_.size() / 2;
+}
+
+template <typename T>
+void ArenaTable<T>::rebuild() {
+    ArenaTable<T> fresh{numSlots_};
+    fresh.arena_.reserve(arena_.size() - deadBytes_);
+    forEach([&fresh](size_t hash, std::string_view word) {
+        fresh.emplaceNew(hash, word);
+    });
+    swap(fresh);
+}
+
+template <typename T>
+template <typename F>
+void ArenaTable<T>::forEach(F&& fn) const {
+    for (size_t val = 0; val < numSlots_; ++val) {
+        if (slots_[val].length != EMPTY && slots_[val].length != VACATED) {
+            fn(slots_[val].hash, word(slots_[val]));
+        }
+    }
+}
+
+template <typename T>
+typename ArenaTable<T>::const_iterator ArenaTable<T>::begin(size_t slot) const {
+    return const_iterator{this, slot};
+}
+
+template <typename T>
+typename ArenaTable<T>::const_iterator ArenaTable<T>::end() const {
+    return const_iterator{this, numSlots_};
+}
+
+template <typename T>
+size_t ArenaTable<T>::nextUsed(size_t slot) const {
+    // skip slots never used and slots whose string was erased or moved
+    while (slot < numSlots_ && (slots_[slot].length == EMPTY
+                                || slots_[slot].length == VACATED)) {
+        ++slot;
+    }
+    return slot;
+}
+
+template <typename T>
+std::string_view ArenaTable<T>::valueAt(size_t slot) const {
+    return word(slots_[slot]);
+}
+
+template <typename T>
+std::ostream& ArenaTable<T>::printToStream(std::ostream& out) const {
+    for (size_t val = 0; val < numSlots_; ++val) {
+        out << "[" << val << "]";
+        if (slots_[val].length != EMPTY && slots_[val].length != VACATED) {
+            out << word(slots_[val]);
+        }
+        out << "\n";
+    }
+    return out;
+}
@@ -0,0 +1,203 @@
+/**
+ * arenatable.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides ArenaTable<std::string>, the interned-string storage layout used
+ * by HashSet<std::string, Arena>.  No std::string objects are stored at
+ * all: every word's bytes are appended to one growing character arena, and
+ * the flat, linearly-probed array of slots holds just (hash, offset,
+ * length) for each word.  Lookups compare keys against the arena directly,
+ * inserting a word costs no allocation of its own, and destroying the
+ * table frees two blocks of memory however many words it holds.
+ *
+ * Because the elements are only ever seen as std::string_view, the set's
+ * KeyEqual policy must accept a std::string_view (std::equal_to<> does).
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef ARENATABLE_HPP_INCLUDED
+#define ARENATABLE_HPP_INCLUDED
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "prefetch.hpp"
+#include "slotiterator.hpp"
+
+template <typename T>
+class ArenaTable {
+    static_assert(std::is_same_v<T, std::string>,
+                  "The Arena layout only stores std::string");
+
+ public:
+    /* \brief Load factor used by HashSet when the client doesn't pick one
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.75;
+    /* \brief Largest load factor the layout can hold; HashSet always grows
+     *        the table before it gets completely full
+     */
+    static constexpr double MAX_LOAD_LIMIT = 0.95;
+    /* \brief Once the strings and vacated slots between them fill the
+     *        default load, an insert rebuilds the table in place if at least
+     *        1/VACATED_DIVISOR of the slots are vacated
+     */
+    static constexpr size_t VACATED_DIVISOR = 32;
+
+    /* \brief Parameterized constructor
+     * \param requested number of slots, rounded up to a power of two
+     */
+    explicit ArenaTable(size_t numBuckets);
+
+    ArenaTable(const ArenaTable<T>& other) = delete;
+    ArenaTable<T>& operator=(const ArenaTable<T>& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(1) time; there are no elements to destroy one by one.
+     */
+    ~ArenaTable();
+
+    /* \brief Swaps the contents of two tables
+     * \note Requires Θ(1) time.
+     */
+    void swap(ArenaTable<T>& other);
+
+    /* \brief Returns the number of slots in the table
+     */
+    size_t buckets() const;
+
+    /* \brief Looks for a string along its probe sequence
+     * \param hash of the string, the string (anything KeyEqual can compare
+     *        with a std::string_view), the equality test, and a counter
+     *        that is set to the number of occupied slots examined
+     * \returns whether the string is in the table
+     */
+    template <typename K, typename KeyEqual>
+    bool contains(size_t hash, const K& key, const KeyEqual& equal,
+                  size_t& steps) const;
+
+    /* \brief Starts loading the memory a search for this hash will read
+     *        first, without waiting for it
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Adds a string known not to be in the table, copying its bytes
+     *        to the end of the arena
+     * \param hash of the string, and anything a std::string_view can be
+     *        made from
+     * \returns whether the string's home slot was already occupied
+     * \throws std::length_error if the arena would pass 4 GiB
+     * \note The table must have at least one empty slot.  If erased strings
+     *       have left too many vacated slots (see VACATED_DIVISOR) or more
+     *       dead bytes than live ones in the arena, the table is rebuilt at
+     *       the same size first, in Θ(m) amortized-away time.
+     */
+    template <typename... Args>
+    bool emplaceNew(size_t hash, Args&&... args);
+
+    /* \brief Removes a string, if it is in the table, leaving its slot
+     *        vacated (its slot and bytes are reclaimed when the table is
+     *        next rebuilt, by a later insert or by HashSet)
+     * \param hash of the value, the value (or any key that compares equal
+     *        to one), and the equality test
+     * \returns whether the value was there
+     */
+    template <typename K, typename KeyEqual>
+    bool erase(size_t hash, const K& key, const KeyEqual& equal);
+
+    /* \brief Copies the string in one slot into another table's arena,
+     *        leaving the slot vacated (probes continue past it)
+     * \param index of the slot and the table to move the string into
+     * \returns the number of strings moved
+     */
+    size_t transferBucket(size_t bucket, ArenaTable<T>& dest);
+
+    /* \brief Calls fn(hash, word) for every string in the table, with the
+     *        string's cached hash and a std::string_view into the arena
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Prints the table one slot per line
+     */
+    std::ostream& printToStream(std::ostream& out) const;
+
+    /* \brief Forward iterator that walks through the slots in order,
+     *        giving a std::string_view into the arena for each string
+     */
+    using const_iterator = SlotIterator<ArenaTable<T>>;
+
+    /* \brief Returns an iterator to the first string in a slot at or after
+     *        the given one (so begin() is the first of them all)
+     */
+    const_iterator begin(size_t slot = 0) const;
+
+    /* \brief Returns the iterator just past the last string
+     */
+    const_iterator end() const;
+
+ private:
+    // Lengths that mark slots with no string in them
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+    static constexpr uint32_t VACATED = UINT32_MAX - 1;
+
+    /* \brief One entry in the flat array: where the string's bytes are in
+     *        the arena, and its full hash value
+     */
+    struct Slot {
+        size_t hash = 0;
+        uint32_t offset = 0;
+        uint32_t length = EMPTY;
+    };
+
+    /* \brief Returns the arena bytes of the string in a full slot
+     */
+    std::string_view word(const Slot& slot) const;
+
+    /* \brief Maps a hash value to its home slot (Fibonacci hashing, as in
+     *        RobinHoodTable)
+     */
+    size_t home(size_t hash) const;
+
+    /* \brief Returns whether erased strings have left enough behind, in
+     *        vacated slots or dead arena bytes, to be worth a rebuild
+     */
+    bool needsRebuild() const;
+
+    /* \brief Rebuilds the table at the same size, dropping every vacated
+     *        slot and packing the live strings' bytes into a new arena
+     */
+    void rebuild();
+
+    // the iterator finds its way around with these two
+    friend class SlotIterator<ArenaTable<T>>;
+
+    /* \brief Returns the first slot in use at or after the given one, or
+     *        the number of slots if there is none
+     */
+    size_t nextUsed(size_t slot) const;
+
+    /* \brief Returns the string in a slot that is in use
+     */
+    std::string_view valueAt(size_t slot) const;
+
+    Slot* slots_;              // the flat array of slots
+    size_t numSlots_;          // Number of slots, always a power of two
+    size_t shift_;             // how far to shift a mixed hash to index slots
+    std::vector<char> arena_;  // every string's bytes, back to back
+    size_t size_;              // Number of strings in the table
+    size_t vacated_;           // Number of vacated slots
+    size_t deadBytes_;         // arena bytes of strings no longer here
+};
+
+#include "arenatable-private.hpp"
+
+#endif  // ARENATABLE_HPP_INCLUDED
@@ -0,0 +1,100 @@
+/**
+ * bloomfilter-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements BloomFilter, a blocked Bloom filter (kept inline, like the rest
+ * of HashSet, so that HashSet stays header-only)
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef BLOOMFILTER_HPP_INCLUDED
+#warning "Don't include this file directly. Include bloomfilter.hpp instead."
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+inline BloomFilter::BloomFilter(size_t expectedKeys, double falsePositiveRate)
+    : blocks_{}, numProbes_{1}, capacity_{std::max(expectedKeys, size_t(1))},
+      falsePositiveRate_{falsePositiveRate} {
+    if (!(falsePositiveRate > 0.0 && falsePositiveRate < 1.0)) {
+        throw std::invalid_argument(
+            "Bloom filter false-positive rate must be between 0 and 1");
+    }
+    // A classic Bloom filter needs log2(1/p) / ln 2 bits per key; keeping
+    // each key's bits in one block makes some blocks fuller than others, so
+    // we give it a quarter more to stay near the target.
+    const double LN2 = std::log(2.0);
+    double bits = -std::log2(falsePositiveRate) / LN2 * 1.25;
+    numProbes_ = std::clamp(size_t(std::lround(bits * LN2 / 1.25)),
+                            size_t(1), size_t(16));
+    size_t numBlocks =
+        size_t(std::ceil(bits * double(capacity_) / BLOCK_BITS));
+    blocks_.resize(std::max(numBlocks, size_t(1)), Block{});
+}
+
+inline uint64_t BloomFilter::mix(size_t hash) {
+    // the MurmurHash3 finalizer, so every input bit affects every output bit
+    uint64_t mixed = hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xFF51AFD7ED558CCDULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xC4CEB9FE1A85EC53ULL;
+    mixed ^= mixed >> 33;
+    return mixed;
+}
+
+inline size_t BloomFilter::blockFor(uint64_t mixed) const {
+    // scales the top 32 bits to the number of blocks (no division needed)
+    return size_t(((mixed >> 32) * blocks_.size()) >> 32);
+}
+
+inline void BloomFilter::add(size_t hash) {
+    uint64_t mixed = mix(hash);
+    Block& block = blocks_[blockFor(mixed)];
+    // double hashing picks the bits within the block
+    uint64_t bits = mixed * 0x9E3779B97F4A7C15ULL;
+    uint32_t position = uint32_t(bits);
+    uint32_t stride = uint32_t(bits >> 32) | 1;
+    for (size_t i = 0; i < numProbes_; ++i, position += stride) {
+        size_t bit = position % BLOCK_BITS;
+        block.words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+inline bool BloomFilter::mayContain(size_t hash) const {
+    uint64_t mixed = mix(hash);
+    const Block& block = blocks_[blockFor(mixed)];
+    uint64_t bits = mixed * 0x9E3779B97F4A7C15ULL;
+    uint32_t position = uint32_t(bits);
+    uint32_t stride = uint32_t(bits >> 32) | 1;
+    for (size_t i = 0; i < numProbes_; ++i, position += stride) {
+        size_t bit = position % BLOCK_BITS;
+        if (!(block.words[bit / 64] & (uint64_t(1) << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline void BloomFilter::prefetch(size_t hash) const {
+    prefetchForRead(&blocks_[blockFor(mix(hash))]);
+}
+
+inline size_t BloomFilter::capacity() const {
+    return capacity_;
+}
+
+inline double BloomFilter::falsePositiveRate() const {
+    return falsePositiveRate_;
+}
+
+inline double BloomFilter::bitsPerKey() const {
+    return double(blocks_.size() * BLOCK_BITS) / capacity_;
+}
@@ -0,0 +1,85 @@
+/**
+ * bloomfilter.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides BloomFilter, a blocked Bloom filter over precomputed hash values.
+ * Each key sets (and is checked against) bits inside a single 64-byte block,
+ * so asking about a key that was never added costs one cache line.  HashSet
+ * can consult one before touching its buckets.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef BLOOMFILTER_HPP_INCLUDED
+#define BLOOMFILTER_HPP_INCLUDED
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "prefetch.hpp"
+
+class BloomFilter {
+ public:
+    /* \brief Number of bits in one block (one cache line)
+     */
+    static constexpr size_t BLOCK_BITS = 512;
+
+    /* \brief Parameterized constructor
+     * \param number of keys the filter should be sized for, and the
+     *        false-positive rate to aim for at that many keys
+     */
+    BloomFilter(size_t expectedKeys, double falsePositiveRate);
+
+    /* \brief Records a key, given its hash value
+     * \note Takes Θ(1) time.
+     */
+    void add(size_t hash);
+
+    /* \brief Returns false if the key with this hash was definitely never
+     *        added, true if it might have been
+     * \note Takes Θ(1) time and touches one cache line.
+     */
+    bool mayContain(size_t hash) const;
+
+    /* \brief Starts loading the block mayContain(hash) will read
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Returns the number of keys the filter was sized for
+     */
+    size_t capacity() const;
+
+    /* \brief Returns the false-positive rate the filter was sized for
+     */
+    double falsePositiveRate() const;
+
+    /* \brief Returns the number of bits each key gets, on average
+     */
+    double bitsPerKey() const;
+
+ private:
+    struct alignas(64) Block {
+        uint64_t words[BLOCK_BITS / 64];
+    };
+
+    /* \brief Picks the block for a hash
+     */
+    size_t blockFor(uint64_t mixed) const;
+
+    /* \brief Remixes a hash (which may have weak bits) for the filter's use
+     */
+    static uint64_t mix(size_t hash);
+
+    std::vector<Block> blocks_;  // the filter's bits
+    size_t numProbes_;           // bits set per key
+    size_t capacity_;            // keys the filter was sized for
+    double falsePositiveRate_;   // target rate at capacity_ keys
+};
+
+#include "bloomfilter-private.hpp"
+
+#endif  // BLOOMFILTER_HPP_INCLUDED
@@ -0,0 +1,212 @@
+/**
+ * chainedtable-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements ChainedTable<T>, the separate-chaining layout for HashSet
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CHAINEDTABLE_HPP_INCLUDED
+#warning "Don't include this file directly. Include chainedtable.hpp instead."
+#endif
+
+#include <iostream>
+#include <forward_list>
+#include <utility>
+#include <cstddef>
+
+template <typename T>
+ChainedTable<T>::ChainedTable(size_t numBuckets)
+    : buckets_{new std::forward_list<Entry>[numBuckets]},
+      numBuckets_{numBuckets} {
+    // nothing needed here! everything initialized
+}
+
+template <typename T>
+ChainedTable<T>::~ChainedTable() {
+    delete[] buckets_;
+}
+
+template <typename T>
+void ChainedTable<T>::swap(ChainedTable<T>& other) {
+    using std::swap;
+    swap(buckets_, other.buckets_);
+    swap(numBuckets_, other.numBuckets_);
+}
+
+template <typename T>
+size_t ChainedTable<T>::buckets() const {
+    return numBuckets_;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool ChainedTable<T>::contains(size_t hash, const K& key,
+                               const KeyEqual& equal, size_t& steps) const {
+    const std::forward_list<Entry>& bucket = buckets_[hash % numBuckets_];
+    steps = 0;
+    for (auto i = bucket.begin(); i != bucket.end(); ++i) {
+        // steps keeps track of how far down the chain we had to go
+        ++steps;
+        // only compare the values themselves if the full hashes agree
+        if (i->hash == hash && equal(i->value, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void ChainedTable<T>::prefetch(size_t hash) const {
+    // the list's first node can't be found until its head has arrived
+    prefetchForRead(&buckets_[hash % numBuckets_]);
+}
+
+template <typename T>
+template <typename... Args>
+bool ChainedTable<T>::emplaceNew(size_t hash, Args&&... args) {
+    std::forward_list<Entry>& bucket = buckets_[hash % numBuckets_];
+    bool collided = !bucket.empty();
+    bucket.emplace_front(hash, std::forward<Args>(args)...);
+    return collided;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool ChainedTable<T>::erase(size_t hash, const K& key,
+                            const KeyEqual& equal) {
+    std::forward_list<Entry>& bucket = buckets_[hash % numBuckets_];
+    // a singly-linked list unlinks the node after the one we're holding
+    for (auto prev = bucket.before_begin(), i = bucket.begin();
+         i != bucket.end(); prev = i++) {
+        if (i->hash == hash && equal(i->value, key)) {
+            bucket.erase_after(prev);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+size_t ChainedTable<T>::transferBucket(size_t bucket,
+                                       ChainedTable<T>& dest) {
+    std::forward_list<Entry>& source = buckets_[bucket];
+    size_t moved = 0;
+    while (!source.empty()) {
+        // the cached hash means we never need to call myhash again
+        std::forward_list<Entry>& target =
+            dest.buckets_[source.front().hash % dest.numBuckets_];
+        // unlink the first node and relink it at the front of its new bucket
+        target.splice_after(target.before_begin(), source,
+                            source.before_begin());
+        ++moved;
+    }
+    return moved;
+}
+
+template <typename T>
+template <typename F>
+void ChainedTable<T>::forEach(F&& fn) const {
+    for (size_t val = 0; val < numBuckets_; ++val) {
+        for (const Entry& entry : buckets_[val]) {
+            fn(entry.hash, entry.value);
+        }
+    }
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator ChainedTable<T>::begin(
+    size_t bucket) const {
+    return const_iterator{this, bucket};
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator ChainedTable<T>::end() const {
+    return const_iterator{this, numBuckets_};
+}
+
+template <typename T>
+ChainedTable<T>::const_iterator::const_iterator(const ChainedTable* table,
+                                                size_t bucket)
+    : table_{table}, bucket_{bucket}, entry_{} {
+    if (bucket_ < table_->numBuckets_) {
+        entry_ = table_->buckets_[bucket_].begin();
+        skipEmptyBuckets();
+    }
+}
+
+template <typename T>
+void ChainedTable<T>::const_iterator::skipEmptyBuckets() {
+    while (entry_ == table_->buckets_[bucket_].end()) {
+        ++bucket_;
+        if (bucket_ == table_->numBuckets_) {
+            // every end iterator looks the same
+            entry_ = ChainIter{};
+            return;
+        }
+        entry_ = table_->buckets_[bucket_].begin();
+    }
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator::reference
+ChainedTable<T>::const_iterator::operator*() const {
+    return entry_->value;
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator::pointer
+ChainedTable<T>::const_iterator::operator->() const {
+    return &entry_->value;
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator&
+ChainedTable<T>::const_iterator::operator++() {
+    ++entry_;
+    skipEmptyBuckets();
+    return *this;
+}
+
+template <typename T>
+typename ChainedTable<T>::const_iterator
+ChainedTable<T>::const_iterator::operator++(int) {
+    const_iterator before = *this;
+    ++*this;
+    return before;
+}
+
+template <typename T>
+bool ChainedTable<T>::const_iterator::operator==(
+    const const_iterator& other) const {
+    return table_ == other.table_ && bucket_ == other.bucket_
+           && entry_ == other.entry_;
+}
+
+template <typename T>
+bool ChainedTable<T>::const_iterator::operator!=(
+    const const_iterator& other) const {
+    return !(*this == other);
+}
+
+template <typename T>
+std::ostream& ChainedTable<T>::printToStream(std::ostream& out) const {
+    for (size_t val = 0; val < numBuckets_; ++val) {
+        out << "[";
+        out << val;
+        out << "]";
+        for (auto item = buckets_[val].begin(); item != buckets_[val].end();
+             ++item) {
+            // prints ", " unless at beginning of the current bucket
+            if (!(item == buckets_[val].begin())) {
+                out << ", ";
+            }
+            out << item->value;
+        }
+        out << "\n";
+    }
+    return out;
+}
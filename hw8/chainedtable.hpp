@@ -0,0 +1,184 @@
+/**
+ * chainedtable.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides ChainedTable<T>, the separate-chaining storage layout used by
+ * HashSet<T, Chaining>.  Every bucket is a singly-linked list of elements,
+ * each stored alongside its full hash value so that rehashing never has to
+ * hash an element again and searches can skip most mismatches by comparing
+ * integers instead of elements.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CHAINEDTABLE_HPP_INCLUDED
+#define CHAINEDTABLE_HPP_INCLUDED
+
+#include <iostream>
+#include <forward_list>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <cstddef>
+
+#include "prefetch.hpp"
+
+template <typename T>
+class ChainedTable {
+ public:
+    /* \brief Load factor used by HashSet when the client doesn't pick one
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 4.0;
+    /* \brief Largest load factor the layout can physically hold (chains can
+     *        grow without bound)
+     */
+    static constexpr double MAX_LOAD_LIMIT =
+        std::numeric_limits<double>::infinity();
+
+    /* \brief Parameterized constructor
+     * \param number of buckets in the table
+     */
+    explicit ChainedTable(size_t numBuckets);
+
+    ChainedTable(const ChainedTable<T>& other) = delete;
+    ChainedTable<T>& operator=(const ChainedTable<T>& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(n) time, where n is the number of elements.
+     */
+    ~ChainedTable();
+
+    /* \brief Swaps the contents of two tables
+     * \note Requires Θ(1) time.
+     */
+    void swap(ChainedTable<T>& other);
+
+    /* \brief Returns the number of buckets in the table
+     */
+    size_t buckets() const;
+
+    /* \brief Looks for a value in the bucket selected by its hash
+     * \param hash of the value, the value (a T or any key that compares
+     *        equal to one), the equality test, and a counter that is set to
+     *        the number of elements examined
+     * \returns whether the value is in the table
+     */
+    template <typename K, typename KeyEqual>
+    bool contains(size_t hash, const K& key, const KeyEqual& equal,
+                  size_t& steps) const;
+
+    /* \brief Starts loading the memory a search for this hash will read
+     *        first, without waiting for it
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Adds a value known not to be in the table, constructing it in
+     *        place from the given arguments
+     * \returns whether the value's bucket was already occupied (a collision)
+     */
+    template <typename... Args>
+    bool emplaceNew(size_t hash, Args&&... args);
+
+    /* \brief Removes a value, if it is in the table, unlinking its node
+     *        from the chain
+     * \param hash of the value, the value (or any key that compares equal
+     *        to one), and the equality test
+     * \returns whether the value was there
+     */
+    template <typename K, typename KeyEqual>
+    bool erase(size_t hash, const K& key, const KeyEqual& equal);
+
+    /* \brief Moves every element of one bucket into another table, leaving
+     *        the bucket empty.  The list nodes themselves are relinked, so no
+     *        element is copied and no memory is allocated.
+     * \param index of the bucket and the table to move the elements into
+     * \returns the number of elements moved
+     */
+    size_t transferBucket(size_t bucket, ChainedTable<T>& dest);
+
+    /* \brief Calls fn(hash, element) for every element in the table, with
+     *        the element's cached hash
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Prints the table one bucket per line
+     */
+    std::ostream& printToStream(std::ostream& out) const;
+
+ private:
+    /* \brief An element together with its cached hash value
+     */
+    struct Entry {
+        template <typename... Args>
+        explicit Entry(size_t h, Args&&... args)
+            : hash{h}, value(std::forward<Args>(args)...) {
+        }
+
+        size_t hash;
+        T value;
+    };
+
+ public:
+    /* \brief Forward iterator over the elements, bucket by bucket and then
+     *        along each chain
+     */
+    class const_iterator {
+     public:
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        /* \brief Default constructor, giving an iterator that can only be
+         *        assigned to
+         */
+        const_iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+     private:
+        friend class ChainedTable;
+        using ChainIter = typename std::forward_list<Entry>::const_iterator;
+
+        /* \brief Starts at the first element of the chain in a bucket, or
+         *        in the first nonempty bucket after it
+         */
+        const_iterator(const ChainedTable* table, size_t bucket);
+
+        /* \brief Moves on from an exhausted chain to the next nonempty one
+         */
+        void skipEmptyBuckets();
+
+        const ChainedTable* table_ = nullptr;  // the table being walked
+        size_t bucket_ = 0;                    // the current bucket
+        ChainIter entry_;  // position in its chain (unused at the end)
+    };
+
+    /* \brief Returns an iterator to the first element in a bucket at or
+     *        after the given one (so begin() is the first of them all)
+     */
+    const_iterator begin(size_t bucket = 0) const;
+
+    /* \brief Returns the iterator just past the last element
+     */
+    const_iterator end() const;
+
+ private:
+
+    std::forward_list<Entry>* buckets_;  // contains the items in the table
+    size_t numBuckets_;                  // Number of buckets
+};
+
+#include "chainedtable-private.hpp"
+
+#endif  // CHAINEDTABLE_HPP_INCLUDED
@@ -0,0 +1,256 @@
+/**
+ * concurrenthashset-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements ConcurrentHashSet<T>, a sharded hash set for many threads
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CONCURRENTHASHSET_HPP_INCLUDED
+#warning "Don't include this file directly. Include concurrenthashset.hpp instead."
+#endif
+
+#include <iostream>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+ConcurrentHashSet<T, Layout, Hash, KeyEqual>::ConcurrentHashSet(
+    size_t numShards, size_t numBuckets, double maxLoadFactor,
+    const Hash& hash, const KeyEqual& equal)
+    : hash_{hash}, shards_{nullptr}, numShards_{1} {
+    while (numShards_ < numShards) {
+        numShards_ *= 2;
+    }
+    shards_.reset(new Guarded[numShards_]);
+    // each shard starts with its share of the buckets
+    size_t shardBuckets = std::max(numBuckets / numShards_, size_t(1));
+    for (size_t i = 0; i < numShards_; ++i) {
+        Shard fresh(shardBuckets, maxLoadFactor, hash, equal);
+        shards_[i].set.swap(fresh);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+ConcurrentHashSet<T, Layout, Hash, KeyEqual>::WriteGuard::WriteGuard(
+    Guarded& shard)
+    : shard_{shard} {
+    shard_.lock.lock();
+    // Readers add themselves before they check the flag, and we raise the
+    // flag before we check for readers, so (with sequentially consistent
+    // atomics) either they see the flag or we see them.
+    shard_.writing.store(true);
+    while (shard_.readers.load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+ConcurrentHashSet<T, Layout, Hash, KeyEqual>::WriteGuard::~WriteGuard() {
+    shard_.writing.store(false);
+    shard_.lock.unlock();
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename ConcurrentHashSet<T, Layout, Hash, KeyEqual>::Guarded&
+ConcurrentHashSet<T, Layout, Hash, KeyEqual>::shardFor(size_t hash) const {
+    // the MurmurHash3 finalizer, so every hash bit affects the shard
+    uint64_t mixed = hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xFF51AFD7ED558CCDULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xC4CEB9FE1A85EC53ULL;
+    mixed ^= mixed >> 33;
+    return shards_[mixed & (numShards_ - 1)];
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::search(size_t hash,
+                                                          const K& key) const {
+    Guarded& shard = shardFor(hash);
+    size_t steps;
+    bool filtered;
+    bool found;
+    shard.readers.fetch_add(1);
+    if (!shard.writing.load()) {
+        // no writer can start until we leave, so the table holds still
+        found = shard.set.find(hash, key, steps, filtered);
+        shard.readers.fetch_sub(1);
+    } else {
+        // a writer is busy, so step aside and wait for it like a writer
+        // would (but alongside any other waiting readers)
+        shard.readers.fetch_sub(1);
+        std::shared_lock<std::shared_mutex> lock{shard.lock};
+        found = shard.set.find(hash, key, steps, filtered);
+    }
+    // records the longest search without disturbing the HashSet
+    size_t longest = shard.maximal.load(std::memory_order_relaxed);
+    while (steps > longest
+           && !shard.maximal.compare_exchange_weak(
+               longest, steps, std::memory_order_relaxed)) {
+        // longest now holds the current value; try again
+    }
+    return found;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename V>
+void ConcurrentHashSet<T, Layout, Hash, KeyEqual>::insertHashed(size_t hash,
+                                                                V&& value) {
+    Guarded& shard = shardFor(hash);
+    WriteGuard guard{shard};
+    shard.set.insertHashed(hash, std::forward<V>(value));
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void ConcurrentHashSet<T, Layout, Hash, KeyEqual>::insert(const T& value) {
+    insertHashed(hash_(value), value);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void ConcurrentHashSet<T, Layout, Hash, KeyEqual>::insert(T&& value) {
+    insertHashed(hash_(value), std::move(value));
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::eraseHashed(size_t hash,
+                                                               const K& key) {
+    // the write guard waits out lock-free readers, so none of them can be
+    // looking at the element when it is destroyed
+    Guarded& shard = shardFor(hash);
+    WriteGuard guard{shard};
+    return shard.set.eraseHashed(hash, key);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::erase(const T& value) {
+    return eraseHashed(hash_(value), value);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K, typename>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::erase(const K& key) {
+    return eraseHashed(hash_(key), key);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::exists(
+    const T& value) const {
+    return search(hash_(value), value);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K, typename>
+bool ConcurrentHashSet<T, Layout, Hash, KeyEqual>::exists(const K& key) const {
+    return search(hash_(key), key);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void ConcurrentHashSet<T, Layout, Hash, KeyEqual>::incrementalRehash(
+    bool incremental) {
+    for (size_t i = 0; i < numShards_; ++i) {
+        WriteGuard guard{shards_[i]};
+        shards_[i].set.incrementalRehash(incremental);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::shards() const {
+    return numShards_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename F>
+void ConcurrentHashSet<T, Layout, Hash, KeyEqual>::forEachShard(
+    F&& fn) const {
+    for (size_t i = 0; i < numShards_; ++i) {
+        std::shared_lock<std::shared_mutex> lock{shards_[i].lock};
+        fn(shards_[i]);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::size() const {
+    size_t total = 0;
+    forEachShard([&](const Guarded& shard) { total += shard.set.size(); });
+    return total;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::buckets() const {
+    size_t total = 0;
+    forEachShard([&](const Guarded& shard) { total += shard.set.buckets(); });
+    return total;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+double ConcurrentHashSet<T, Layout, Hash, KeyEqual>::loadFactor() const {
+    // read both totals under the same locks, so they agree with each other
+    size_t elements = 0;
+    size_t totalBuckets = 0;
+    forEachShard([&](const Guarded& shard) {
+        elements += shard.set.size();
+        totalBuckets += shard.set.buckets();
+    });
+    return double(elements) / totalBuckets;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::reallocations() const {
+    size_t total = 0;
+    forEachShard(
+        [&](const Guarded& shard) { total += shard.set.reallocations(); });
+    return total;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::collisions() const {
+    size_t total = 0;
+    forEachShard(
+        [&](const Guarded& shard) { total += shard.set.collisions(); });
+    return total;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::maximal() const {
+    // inserts record their searches in the shard's HashSet, lookups in the
+    // shard's own counter
+    size_t longest = 0;
+    forEachShard([&](const Guarded& shard) {
+        longest = std::max({longest, shard.set.maximal(),
+                            shard.maximal.load(std::memory_order_relaxed)});
+    });
+    return longest;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t ConcurrentHashSet<T, Layout, Hash, KeyEqual>::worstInsert() const {
+    size_t worst = 0;
+    forEachShard([&](const Guarded& shard) {
+        worst = std::max(worst, shard.set.worstInsert());
+    });
+    return worst;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::ostream& ConcurrentHashSet<T, Layout, Hash, KeyEqual>::showStatistics(
+    std::ostream& out) const {
+    return out << reallocations() << " expansions"
+               << ", "
+               << "load factor " << loadFactor() << ", " << collisions()
+               << " collisions"
+               << ", "
+               << "longest run " << maximal() << ", "
+               << "worst insert moved " << worstInsert() << ", " << shards()
+               << " shards" << std::endl;
+}
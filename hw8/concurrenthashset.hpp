@@ -0,0 +1,189 @@
+/**
+ * concurrenthashset.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides ConcurrentHashSet<T, Layout, Hash, KeyEqual>, a set that many
+ * threads can search and insert into at once.  It is split into shards,
+ * each an ordinary HashSet with its own lock, and every element belongs to
+ * the shard its hash picks, so threads working on different shards never
+ * wait for each other.
+ *
+ * Searches don't take a lock at all unless a writer is busy in their
+ * shard: a reader just announces itself on the shard's reader count and
+ * checks that no writer has started.  A writer takes the shard's lock,
+ * raises its writing flag, and waits for any announced readers to finish
+ * before touching the table; readers that arrive while the flag is up wait
+ * on the lock instead.  Searches never change the shard's HashSet (each
+ * shard keeps its own atomic search statistics), and the statistics of all
+ * the shards are only combined when they are asked for.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CONCURRENTHASHSET_HPP_INCLUDED
+#define CONCURRENTHASHSET_HPP_INCLUDED
+
+#include <iostream>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <cstddef>
+
+#include "hashset.hpp"
+
+template <typename T, typename Layout = Chaining, typename Hash = MyHash,
+          typename KeyEqual = std::equal_to<>>
+class ConcurrentHashSet {
+ public:
+    /* \brief The kind of HashSet each shard is
+     */
+    using Shard = HashSet<T, Layout, Hash, KeyEqual>;
+
+    /* \brief Enables an overload only for transparent key types
+     */
+    template <typename K>
+    using EnableIfTransparent =
+        typename Shard::template EnableIfTransparent<K>;
+
+    /* \brief Default number of shards (rounded up to a power of two)
+     */
+    static constexpr size_t DEFAULT_NUM_SHARDS = 16;
+
+    /* \brief Parameterized constructor
+     * \param number of shards, initial number of buckets (shared out among
+     *        the shards), maximum load factor, and the hash and equality
+     *        objects to use
+     * This constructor is also the default constructor
+     */
+    explicit ConcurrentHashSet(
+        size_t numShards = DEFAULT_NUM_SHARDS,
+        size_t numBuckets = Shard::DEFAULT_NUM_BUCKETS,
+        double maxLoadFactor = Shard::DEFAULT_MAX_LOAD_FACTOR,
+        const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual());
+
+    ConcurrentHashSet(const ConcurrentHashSet& other) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(n) time.  No other thread may be using the set.
+     */
+    ~ConcurrentHashSet() = default;
+
+    /* \brief Inserts an item (copied or moved) into its shard
+     * \param the item to insert
+     * \note Safe to call from any number of threads at once.  Same time
+     *       bounds as HashSet::insert, plus waiting for the shard's lock.
+     */
+    void insert(const T&);
+    void insert(T&&);
+
+    /* \brief Removes an item from its shard, if it is there
+     * \param the item (or a transparent key) to remove
+     * \returns whether the item was there
+     * \note Safe to call from any number of threads at once.  Same time
+     *       bounds as HashSet::erase, plus waiting for the shard's lock.
+     */
+    bool erase(const T&);
+    template <typename K, typename = EnableIfTransparent<K>>
+    bool erase(const K&);
+
+    /* \brief Returns whether an item is in the set
+     * \param the item (or a transparent key) to search for
+     * \note Safe to call from any number of threads at once.  Takes no lock
+     *       unless the item's shard is being written to.
+     */
+    bool exists(const T&) const;
+    template <typename K, typename = EnableIfTransparent<K>>
+    bool exists(const K&) const;
+
+    /* \brief Turns incremental rehashing on or off in every shard
+     */
+    void incrementalRehash(bool);
+
+    /* \brief Returns the number of shards
+     * \note Takes Θ(1) time.
+     */
+    size_t shards() const;
+
+    /* \brief Statistics, summed over the shards (maximal() and
+     *        worstInsert() take the largest of any shard instead)
+     * \note Each takes Θ(s) time, where s is the number of shards, and waits
+     *       for any writer in each shard to finish.
+     */
+    size_t size() const;
+    size_t buckets() const;
+    double loadFactor() const;
+    size_t reallocations() const;
+    size_t collisions() const;
+    size_t maximal() const;
+    size_t worstInsert() const;
+
+    /* \brief Prints the combined statistics to a stream, in the same form
+     *        as HashSet::showStatistics
+     * \param the stream to print to
+     */
+    std::ostream& showStatistics(std::ostream&) const;
+
+ private:
+    /* \brief One shard and everything that guards it, on its own cache
+     *        lines so that threads using different shards don't share any
+     */
+    struct alignas(64) Guarded {
+        mutable std::shared_mutex lock;          // held by writers
+        mutable std::atomic<size_t> readers{0};  // lock-free readers inside
+        std::atomic<bool> writing{false};        // a writer wants the table
+        mutable std::atomic<size_t> maximal{0};  // longest search by readers
+        Shard set;                               // the elements themselves
+    };
+
+    /* \brief Holds a shard exclusively for as long as it exists: takes the
+     *        lock, raises the writing flag, and waits for lock-free readers
+     *        to leave
+     */
+    class WriteGuard {
+     public:
+        explicit WriteGuard(Guarded& shard);
+        ~WriteGuard();
+
+     private:
+        Guarded& shard_;
+    };
+
+    /* \brief Picks the shard for a hash.  Mixes the hash first, so that
+     *        the bits picking the shard aren't the ones the shard's own
+     *        table uses.
+     */
+    Guarded& shardFor(size_t hash) const;
+
+    /* \brief Searches one shard, lock-free if no writer is busy there
+     */
+    template <typename K>
+    bool search(size_t hash, const K& key) const;
+
+    /* \brief Inserts a value with a known hash into its shard
+     */
+    template <typename V>
+    void insertHashed(size_t hash, V&& value);
+
+    /* \brief Removes a value with a known hash from its shard
+     */
+    template <typename K>
+    bool eraseHashed(size_t hash, const K& key);
+
+    /* \brief Calls fn(shard) for every shard, holding each one's lock
+     *        shared (so no writer changes it) while fn looks at it
+     */
+    template <typename F>
+    void forEachShard(F&& fn) const;
+
+    Hash hash_;                          // picks the shard (and hash in it)
+    std::unique_ptr<Guarded[]> shards_;  // the shards
+    size_t numShards_;                   // Number of shards, a power of two
+};
+
+#include "concurrenthashset-private.hpp"
+
+#endif  // CONCURRENTHASHSET_HPP_INCLUDED
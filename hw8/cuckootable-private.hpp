@@ -0,0 +1,348 @@
+/**
+ * cuckootable-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements CuckooTable<T>, the bucketized cuckoo hashing layout for
+ * HashSet
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CUCKOOTABLE_HPP_INCLUDED
+#warning "Don't include this file directly. Include cuckootable.hpp instead."
+#endif
+
+#include <iostream>
+#include <algorithm>
+#include <optional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T>
+CuckooTable<T>::CuckooTable(size_t numBuckets)
+    : buckets_{nullptr},
+      values_{nullptr},
+      numBuckets_{2},
+      shift_{0},
+      size_{0},
+      random_{0x9E3779B97F4A7C15ULL},
+      stash_{} {
+    // round up to a power of two buckets (at least two, so the shift stays
+    // in range)
+    while (numBuckets_ * BUCKET_SIZE < numBuckets) {
+        numBuckets_ *= 2;
+    }
+    size_t bits = 0;
+    while ((size_t(1) << bits) < numBuckets_) {
+        ++bits;
+    }
+    shift_ = std::numeric_limits<size_t>::digits - bits;
+    buckets_ = new Bucket[numBuckets_];
+    values_ = new std::optional<T>[numBuckets_ * BUCKET_SIZE];
+}
+
+template <typename T>
+CuckooTable<T>::~CuckooTable() {
+    delete[] buckets_;
+    delete[] values_;
+}
+
+template <typename T>
+void CuckooTable<T>::swap(CuckooTable<T>& other) {
+    using std::swap;
+    swap(buckets_, other.buckets_);
+    swap(values_, other.values_);
+    swap(numBuckets_, other.numBuckets_);
+    swap(shift_, other.shift_);
+    swap(size_, other.size_);
+    swap(random_, other.random_);
+    swap(stash_, other.stash_);
+}
+
+template <typename T>
+size_t CuckooTable<T>::buckets() const {
+    return numBuckets_ * BUCKET_SIZE;
+}
+
+template <typename T>
+size_t CuckooTable<T>::primary(size_t hash) const {
+    // 2^64 / golden ratio
+    constexpr size_t FIBONACCI_MULTIPLIER = size_t(0x9E3779B97F4A7C15ULL);
+    return (hash * FIBONACCI_MULTIPLIER) >> shift_;
+}
+
+template <typename T>
+size_t CuckooTable<T>::alternate(size_t hash) const {
+    uint64_t mixed = hash;
+    mixed ^= mixed >> 33;
+    mixed *= 0xFF51AFD7ED558CCDULL;
+    mixed ^= mixed >> 33;
+    mixed *= 0xC4CEB9FE1A85EC53ULL;
+    mixed ^= mixed >> 33;
+    return size_t(mixed >> shift_);
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool CuckooTable<T>::contains(size_t hash, const K& key,
+                              const KeyEqual& equal, size_t& steps) const {
+    auto inBucket = [&](size_t bucket) {
+        const Bucket& slots = buckets_[bucket];
+        for (size_t i = 0; i < BUCKET_SIZE; ++i) {
+            // only compare the values themselves if the full hashes agree
+            if ((slots.used >> i & 1) && slots.hashes[i] == hash
+                && equal(*values_[bucket * BUCKET_SIZE + i], key)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    steps = 1;
+    size_t first = primary(hash);
+    if (inBucket(first)) {
+        return true;
+    }
+    // nothing that belongs here has ever been put anywhere else
+    if (!buckets_[first].overflowed) {
+        return false;
+    }
+    ++steps;
+    size_t second = alternate(hash);
+    if (second != first && inBucket(second)) {
+        return true;
+    }
+    for (const auto& [stashedHash, value] : stash_) {
+        ++steps;
+        if (stashedHash == hash && equal(value, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void CuckooTable<T>::prefetch(size_t hash) const {
+    prefetchForRead(&buckets_[primary(hash)]);
+    prefetchForRead(&buckets_[alternate(hash)]);
+}
+
+template <typename T>
+bool CuckooTable<T>::place(size_t bucket, size_t hash, T& value) {
+    Bucket& slots = buckets_[bucket];
+    for (size_t i = 0; i < BUCKET_SIZE; ++i) {
+        if (!(slots.used >> i & 1)) {
+            slots.hashes[i] = hash;
+            slots.used |= uint8_t(1 << i);
+            values_[bucket * BUCKET_SIZE + i].emplace(std::move(value));
+            // searches must now look past this element's first bucket
+            if (bucket != primary(hash)) {
+                buckets_[primary(hash)].overflowed = true;
+            }
+            ++size_;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+template <typename... Args>
+bool CuckooTable<T>::emplaceNew(size_t hash, Args&&... args) {
+    T carried(std::forward<Args>(args)...);
+    size_t bucket = primary(hash);
+    if (place(bucket, hash, carried)) {
+        return false;
+    }
+    if (place(alternate(hash), hash, carried)) {
+        return true;
+    }
+
+    // Both buckets are full: evict a random element from one of them, move
+    // it to its other bucket, and repeat until something finds a free slot
+    // (remembering the slots, so that a failed insert can be undone)
+    size_t path[MAX_DISPLACEMENTS];
+    bucket = nextRandom() & 1 ? alternate(hash) : bucket;
+    for (size_t moves = 0; moves < MAX_DISPLACEMENTS; ++moves) {
+        if (bucket != primary(hash)) {
+            buckets_[primary(hash)].overflowed = true;
+        }
+        size_t slot = nextRandom() % BUCKET_SIZE;
+        path[moves] = bucket * BUCKET_SIZE + slot;
+        std::swap(hash, buckets_[bucket].hashes[slot]);
+        std::swap(carried, *values_[path[moves]]);
+        bucket = bucket == primary(hash) ? alternate(hash) : primary(hash);
+        if (place(bucket, hash, carried)) {
+            return true;
+        }
+    }
+
+    // The walk went round in circles, so undo it: swapping back in reverse
+    // order puts every evicted element where it was, and leaves the new
+    // one in our hands again (overflowed flags set along the way only cost
+    // searches a little time).
+    for (size_t moves = MAX_DISPLACEMENTS; moves-- > 0;) {
+        std::swap(hash, buckets_[path[moves] / BUCKET_SIZE]
+                            .hashes[path[moves] % BUCKET_SIZE]);
+        std::swap(carried, *values_[path[moves]]);
+    }
+
+    // Doubling the table usually breaks the circle, but not when the
+    // elements involved have equal hashes, which is the likely cause if the
+    // table is still mostly empty.
+    if (size_ * 2 >= buckets()) {
+        grow();
+        emplaceNew(hash, std::move(carried));
+    } else if (stash_.size() < MAX_STASH) {
+        buckets_[primary(hash)].overflowed = true;
+        stash_.emplace_back(hash, std::move(carried));
+        ++size_;
+    } else {
+        throw std::length_error(
+            "CuckooTable stash is full: too many equal hashes");
+    }
+    return true;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool CuckooTable<T>::erase(size_t hash, const K& key, const KeyEqual& equal) {
+    auto eraseFrom = [&](size_t bucket) {
+        Bucket& slots = buckets_[bucket];
+        for (size_t i = 0; i < BUCKET_SIZE; ++i) {
+            size_t slot = bucket * BUCKET_SIZE + i;
+            if ((slots.used >> i & 1) && slots.hashes[i] == hash
+                && equal(*values_[slot], key)) {
+                values_[slot].reset();
+                slots.used &= uint8_t(~(1 << i));
+                --size_;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    size_t first = primary(hash);
+    if (eraseFrom(first)) {
+        return true;
+    }
+    // the overflowed flag stays set; it only ever makes searches look
+    // further than they need to
+    if (!buckets_[first].overflowed) {
+        return false;
+    }
+    size_t second = alternate(hash);
+    if (second != first && eraseFrom(second)) {
+        return true;
+    }
+    for (auto stashed = stash_.begin(); stashed != stash_.end(); ++stashed) {
+        if (stashed->first == hash && equal(stashed->second, key)) {
+            stash_.erase(stashed);
+            --size_;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void CuckooTable<T>::grow() {
+    CuckooTable<T> bigger{buckets() * 2};
+    for (size_t slot = 0; slot < buckets(); ++slot) {
+        transferBucket(slot, bigger);
+    }
+    swap(bigger);
+}
+
+template <typename T>
+size_t CuckooTable<T>::nextRandom() {
+    random_ ^= random_ << 13;
+    random_ ^= random_ >> 7;
+    random_ ^= random_ << 17;
+    return size_t(random_);
+}
+
+template <typename T>
+size_t CuckooTable<T>::transferBucket(size_t bucket, CuckooTable<T>& dest) {
+    size_t moved = 0;
+    Bucket& slots = buckets_[bucket / BUCKET_SIZE];
+    size_t i = bucket % BUCKET_SIZE;
+    if (slots.used >> i & 1) {
+        // the cached hash means we never need to call myhash again
+        dest.emplaceNew(slots.hashes[i], std::move(*values_[bucket]));
+        values_[bucket].reset();
+        slots.used &= uint8_t(~(1 << i));
+        --size_;
+        ++moved;
+    }
+    // the stash has no slot numbers of its own, so it goes with the last
+    if (bucket == buckets() - 1) {
+        for (auto& [hash, value] : stash_) {
+            dest.emplaceNew(hash, std::move(value));
+            ++moved;
+        }
+        size_ -= stash_.size();
+        stash_.clear();
+    }
+    return moved;
+}
+
+template <typename T>
+template <typename F>
+void CuckooTable<T>::forEach(F&& fn) const {
+    for (size_t slot = 0; slot < buckets(); ++slot) {
+        if (values_[slot]) {
+            fn(buckets_[slot / BUCKET_SIZE].hashes[slot % BUCKET_SIZE],
+               *values_[slot]);
+        }
+    }
+    for (const auto& [hash, value] : stash_) {
+        fn(hash, value);
+    }
+}
+
+template <typename T>
+typename CuckooTable<T>::const_iterator CuckooTable<T>::begin(
+    size_t slot) const {
+    return const_iterator{this, slot};
+}
+
+template <typename T>
+typename CuckooTable<T>::const_iterator CuckooTable<T>::end() const {
+    return const_iterator{this, buckets() + stash_.size()};
+}
+
+template <typename T>
+size_t CuckooTable<T>::nextUsed(size_t slot) const {
+    while (slot < buckets() && !values_[slot]) {
+        ++slot;
+    }
+    // every stashed element is in use
+    return std::min(slot, buckets() + stash_.size());
+}
+
+template <typename T>
+const T& CuckooTable<T>::valueAt(size_t slot) const {
+    return slot < buckets() ? *values_[slot] : stash_[slot - buckets()].second;
+}
+
+template <typename T>
+std::ostream& CuckooTable<T>::printToStream(std::ostream& out) const {
+    for (size_t slot = 0; slot < buckets(); ++slot) {
+        out << "[" << slot << "]";
+        if (values_[slot]) {
+            out << *values_[slot];
+        }
+        out << "\n";
+    }
+    for (const auto& stashed : stash_) {
+        out << "[stash]" << stashed.second << "\n";
+    }
+    return out;
+}
@@ -0,0 +1,220 @@
+/**
+ * cuckootable.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides CuckooTable<T>, the bucketized cuckoo hashing layout used by
+ * HashSet<T, Cuckoo>.  Slots come in buckets of four, and every element
+ * lives in one of just two buckets, picked by two different mixes of its
+ * hash.  Each bucket's cached hashes fit in one cache line, and the
+ * elements are kept in a separate array that is only read when a full
+ * hash matches.  So, whatever the load, a search that misses reads at most
+ * two cache lines (one if the first bucket never overflowed), and a hit
+ * reads one more, for the element itself (plus anything the element points
+ * to, such as a long string's bytes).
+ *
+ * To insert an element when both of its buckets are full, an element is
+ * evicted from one of them and moved to its own other bucket, and so on,
+ * for up to MAX_DISPLACEMENTS moves.  If that walk doesn't find a free
+ * slot, the table doubles in size by itself.  Growing can't separate
+ * elements whose full hashes are equal, though.  So once the table is less
+ * than half full, the element left over goes into a stash of at most
+ * MAX_STASH elements that searches check last; if that is full too, the
+ * insert fails.  The stash stays empty unless the hash gives many elements
+ * the same value, and its size limit keeps every search O(1) even then.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef CUCKOOTABLE_HPP_INCLUDED
+#define CUCKOOTABLE_HPP_INCLUDED
+
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "prefetch.hpp"
+#include "slotiterator.hpp"
+
+template <typename T>
+class CuckooTable {
+ public:
+    /* \brief Load factor used by HashSet when the client doesn't pick one
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.9;
+    /* \brief Largest load factor the layout can hold; past this, inserts
+     *        spend a long time displacing elements
+     */
+    static constexpr double MAX_LOAD_LIMIT = 0.95;
+    /* \brief Number of slots in each bucket
+     */
+    static constexpr size_t BUCKET_SIZE = 4;
+    /* \brief Most elements an insert moves before the table grows instead
+     */
+    static constexpr size_t MAX_DISPLACEMENTS = 128;
+    /* \brief Most elements the stash holds
+     */
+    static constexpr size_t MAX_STASH = 16;
+
+    /* \brief Parameterized constructor
+     * \param requested number of slots, rounded up to a power-of-two number
+     *        of buckets (at least two)
+     */
+    explicit CuckooTable(size_t numBuckets);
+
+    CuckooTable(const CuckooTable<T>& other) = delete;
+    CuckooTable<T>& operator=(const CuckooTable<T>& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(m) time, where m is the number of slots.
+     */
+    ~CuckooTable();
+
+    /* \brief Swaps the contents of two tables
+     * \note Requires Θ(1) time.
+     */
+    void swap(CuckooTable<T>& other);
+
+    /* \brief Returns the number of slots in the table
+     */
+    size_t buckets() const;
+
+    /* \brief Looks for a value in its two buckets (and the stash)
+     * \param hash of the value, the value (a T or any key that compares
+     *        equal to one), the equality test, and a counter that is set to
+     *        the number of buckets examined, plus any stashed elements
+     * \returns whether the value is in the table
+     * \note The second bucket and the stash are only read if something that
+     *       belonged in the first bucket had to go elsewhere.  Takes O(1)
+     *       time in the worst case: two buckets and at most MAX_STASH
+     *       stashed elements.
+     */
+    template <typename K, typename KeyEqual>
+    bool contains(size_t hash, const K& key, const KeyEqual& equal,
+                  size_t& steps) const;
+
+    /* \brief Starts loading both buckets a search for this hash may read,
+     *        without waiting for them
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Adds a value known not to be in the table, constructing it
+     *        from the given arguments
+     * \returns whether the value's first bucket was already full
+     * \throws std::length_error if displacing elements doesn't make room,
+     *         the table is less than half full, and the stash is full; this
+     *         only happens when more than MAX_STASH elements have hashes
+     *         equal to others', and leaves the table as it was
+     * \note If displacing elements doesn't make room, the table grows (or,
+     *       when it is mostly empty, uses the stash).  HashSet can tell the
+     *       table grew from buckets().
+     */
+    template <typename... Args>
+    bool emplaceNew(size_t hash, Args&&... args);
+
+    /* \brief Removes a value, if it is in the table, freeing its slot
+     * \param hash of the value, the value (or any key that compares equal
+     *        to one), and the equality test
+     * \returns whether the value was there
+     */
+    template <typename K, typename KeyEqual>
+    bool erase(size_t hash, const K& key, const KeyEqual& equal);
+
+    /* \brief Moves the element in one slot into another table, leaving the
+     *        slot empty.  Moving the last slot also moves the whole stash.
+     *        The elements are moved, not copied.
+     * \param index of the slot and the table to move the element into
+     * \returns the number of elements moved
+     */
+    size_t transferBucket(size_t bucket, CuckooTable<T>& dest);
+
+    /* \brief Calls fn(hash, element) for every element in the table, with
+     *        the element's cached hash
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Prints the table one slot per line, then the stash (if any)
+     */
+    std::ostream& printToStream(std::ostream& out) const;
+
+    /* \brief Forward iterator over the elements, in slot order and then
+     *        through the stash, giving a const T&
+     */
+    using const_iterator = SlotIterator<CuckooTable<T>>;
+
+    /* \brief Returns an iterator to the first element in a slot at or after
+     *        the given one (so begin() is the first of them all, and
+     *        begin(buckets()) is the start of the stash)
+     */
+    const_iterator begin(size_t slot = 0) const;
+
+    /* \brief Returns the iterator just past the last element (the end of
+     *        the stash)
+     */
+    const_iterator end() const;
+
+ private:
+    /* \brief The cached hashes of one bucket's slots, with a bit per slot
+     *        saying whether it is in use, all in one cache line.
+     *        overflowed says some element whose first bucket this is had
+     *        to be put somewhere else.
+     */
+    struct alignas(64) Bucket {
+        size_t hashes[BUCKET_SIZE] = {};
+        uint8_t used = 0;
+        bool overflowed = false;
+    };
+
+    // the iterator finds its way around with these two
+    friend class SlotIterator<CuckooTable<T>>;
+
+    /* \brief Returns the first slot in use at or after the given one, where
+     *        the stash's elements count as slots after the last bucket's
+     */
+    size_t nextUsed(size_t slot) const;
+
+    /* \brief Returns the element in a slot that is in use (or the stash)
+     */
+    const T& valueAt(size_t slot) const;
+
+    /* \brief Maps a hash value to its first bucket (Fibonacci hashing)
+     */
+    size_t primary(size_t hash) const;
+
+    /* \brief Maps a hash value to its second bucket (the MurmurHash3
+     *        finalizer, so it doesn't follow from the first)
+     */
+    size_t alternate(size_t hash) const;
+
+    /* \brief Puts a value in a free slot of a bucket, if there is one
+     * \returns whether it was placed (and so moved from)
+     */
+    bool place(size_t bucket, size_t hash, T& value);
+
+    /* \brief Doubles the number of buckets, moving every element across
+     */
+    void grow();
+
+    /* \brief Returns the next number from a small xorshift generator, for
+     *        picking which element to evict
+     */
+    size_t nextRandom();
+
+    Bucket* buckets_;            // cached hashes, one cache line per bucket
+    std::optional<T>* values_;   // the elements, BUCKET_SIZE per bucket
+    size_t numBuckets_;          // Number of buckets, always a power of two
+    size_t shift_;               // how far to shift a mixed hash to index
+    size_t size_;                // Number of elements, including the stash
+    uint64_t random_;            // state of the eviction generator
+    std::vector<std::pair<size_t, T>> stash_;  // (hash, element) overflow
+};
+
+#include "cuckootable-private.hpp"
+
+#endif  // CUCKOOTABLE_HPP_INCLUDED
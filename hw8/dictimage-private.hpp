@@ -0,0 +1,255 @@
+/**
+ * dictimage-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements DictImage<Hash>, a memory-mapped dictionary image
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef DICTIMAGE_HPP_INCLUDED
+#warning "Don't include this file directly. Include dictimage.hpp instead."
+#endif
+
+#include <fstream>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename Hash>
+size_t DictImage<Hash>::bucketOf(uint64_t hash, uint64_t bucketBits) {
+    // 2^64 / golden ratio
+    constexpr uint64_t FIBONACCI_MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    return size_t((hash * FIBONACCI_MULTIPLIER) >> (64 - bucketBits));
+}
+
+template <typename Hash>
+template <typename Set>
+void DictImage<Hash>::save(const Set& words, const std::string& filename,
+                           const Hash& hash) {
+    // about one word per bucket, and at least two buckets so the shift in
+    // bucketOf stays in range
+    uint64_t bucketBits = 1;
+    while ((uint64_t(1) << bucketBits) < words.size()) {
+        ++bucketBits;
+    }
+    size_t numBuckets = size_t(1) << bucketBits;
+
+    // first pass: hash every word and count the words in each bucket
+    std::vector<Entry> unsorted;
+    std::vector<std::string_view> text;
+    std::vector<uint32_t> bucketStarts(numBuckets + 1, 0);
+    uint64_t stringBytes = 0;
+    words.forEach([&](std::string_view word) {
+        unsorted.push_back(Entry{hash(word), 0, uint32_t(word.size())});
+        text.push_back(word);
+        ++bucketStarts[bucketOf(unsorted.back().hash, bucketBits) + 1];
+        stringBytes += word.size();
+    });
+    if (stringBytes > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Dictionary too large for an image");
+    }
+    for (size_t i = 0; i < numBuckets; ++i) {
+        bucketStarts[i + 1] += bucketStarts[i];
+    }
+
+    // second pass: place the entries so each bucket's are contiguous
+    std::vector<Entry> entries(unsorted.size());
+    std::vector<uint32_t> next(bucketStarts.begin(), bucketStarts.end() - 1);
+    std::string strings;
+    strings.reserve(stringBytes);
+    for (size_t i = 0; i < unsorted.size(); ++i) {
+        Entry& entry = entries[next[bucketOf(unsorted[i].hash, bucketBits)]++];
+        entry = unsorted[i];
+        entry.offset = uint32_t(strings.size());
+        strings += text[i];
+    }
+
+    // entries hold 64-bit hashes, so they start on an 8-byte boundary
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.hashCheck = hash(HASH_CHECK_KEY);
+    header.numWords = entries.size();
+    header.bucketBits = bucketBits;
+    uint64_t bucketsEnd =
+        sizeof(Header) + bucketStarts.size() * sizeof(uint32_t);
+    header.entriesOffset = (bucketsEnd + 7) / 8 * 8;
+    header.stringsOffset =
+        header.entriesOffset + entries.size() * sizeof(Entry);
+    header.fileSize = header.stringsOffset + strings.size();
+
+    std::ofstream out;
+    out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+    try {
+        out.open(filename, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        out.write(reinterpret_cast<const char*>(bucketStarts.data()),
+                  bucketStarts.size() * sizeof(uint32_t));
+        const char padding[8] = {};
+        out.write(padding, header.entriesOffset - bucketsEnd);
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  entries.size() * sizeof(Entry));
+        out.write(strings.data(), strings.size());
+        out.close();
+    } catch (std::system_error& e) {
+        throw std::system_error(std::make_error_code(std::errc(errno)),
+                                "Error writing '" + filename + "'");
+    }
+}
+
+template <typename Hash>
+DictImage<Hash>::DictImage(const std::string& filename, const Hash& hash)
+    : hash_{hash},
+      base_{nullptr},
+      mappedSize_{0},
+      header_{nullptr},
+      bucketStarts_{nullptr},
+      entries_{nullptr},
+      strings_{nullptr} {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Error opening '" + filename + "'");
+    }
+    struct stat info;
+    if (fstat(fd, &info) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(),
+                                "Error reading '" + filename + "'");
+    }
+    mappedSize_ = size_t(info.st_size);
+    if (mappedSize_ < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("'" + filename
+                                 + "' is not a dictionary image");
+    }
+    void* mapping = mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive, so the descriptor isn't needed
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Error mapping '" + filename + "'");
+    }
+    base_ = static_cast<const unsigned char*>(mapping);
+    header_ = reinterpret_cast<const Header*>(base_);
+
+    // refuse anything we didn't write, or wrote with another hash function
+    std::string problem;
+    if (std::memcmp(header_->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        problem = "is not a dictionary image";
+    } else if (header_->version != VERSION
+               || header_->byteOrder != BYTE_ORDER_MARK) {
+        problem = "was written by an incompatible version or machine";
+    } else if (header_->fileSize != mappedSize_ || header_->bucketBits < 1
+               || header_->bucketBits > 32
+               || header_->entriesOffset
+                      < sizeof(Header) + (buckets() + 1) * sizeof(uint32_t)
+               // (bounding each part first, so the sums can't overflow)
+               || header_->entriesOffset > mappedSize_
+               || header_->entriesOffset % alignof(Entry) != 0
+               || header_->numWords
+                      > (mappedSize_ - header_->entriesOffset) / sizeof(Entry)
+               || header_->stringsOffset
+                      != header_->entriesOffset
+                             + header_->numWords * sizeof(Entry)) {
+        problem = "is damaged";
+    } else if (header_->hashCheck != hash_(HASH_CHECK_KEY)) {
+        problem = "was built with a different hash function";
+    }
+    if (!problem.empty()) {
+        munmap(mapping, mappedSize_);
+        throw std::runtime_error("'" + filename + "' " + problem);
+    }
+    bucketStarts_ = reinterpret_cast<const uint32_t*>(base_ + sizeof(Header));
+    entries_ = reinterpret_cast<const Entry*>(base_ + header_->entriesOffset);
+    strings_ = reinterpret_cast<const char*>(base_ + header_->stringsOffset);
+
+    // every lookup trusts the bucket offsets and the entries, so check
+    // that none of them points outside the file
+    bool damaged = bucketStarts_[0] != 0
+                   || bucketStarts_[buckets()] != header_->numWords;
+    for (size_t i = 0; i < buckets() && !damaged; ++i) {
+        damaged = bucketStarts_[i + 1] < bucketStarts_[i];
+    }
+    uint64_t stringBytes = mappedSize_ - header_->stringsOffset;
+    for (size_t i = 0; i < header_->numWords && !damaged; ++i) {
+        damaged = uint64_t(entries_[i].offset) + entries_[i].length
+                  > stringBytes;
+    }
+    if (damaged) {
+        munmap(mapping, mappedSize_);
+        throw std::runtime_error("'" + filename + "' is damaged");
+    }
+}
+
+template <typename Hash>
+DictImage<Hash>::~DictImage() {
+    munmap(const_cast<unsigned char*>(base_), mappedSize_);
+}
+
+template <typename Hash>
+size_t DictImage<Hash>::size() const {
+    return header_->numWords;
+}
+
+template <typename Hash>
+size_t DictImage<Hash>::buckets() const {
+    return size_t(1) << header_->bucketBits;
+}
+
+template <typename Hash>
+bool DictImage<Hash>::exists(std::string_view word) const {
+    return find(hash_(word), word);
+}
+
+template <typename Hash>
+template <typename ForwardIt, typename OutputIt>
+OutputIt DictImage<Hash>::existsBatch(ForwardIt first, ForwardIt last,
+                                      OutputIt out) const {
+    uint64_t hashes[BATCH_SIZE];
+    while (first != last) {
+        // first pass: hash a window of words and start loading their buckets
+        ForwardIt window = first;
+        size_t count = 0;
+        for (; count < BATCH_SIZE && first != last; ++count, ++first) {
+            hashes[count] = hash_(std::string_view{*first});
+            prefetchForRead(
+                &bucketStarts_[bucketOf(hashes[count], header_->bucketBits)]);
+        }
+        // second pass: search them
+        for (size_t i = 0; i < count; ++i, ++window) {
+            *out = find(hashes[i], std::string_view{*window});
+            ++out;
+        }
+    }
+    return out;
+}
+
+template <typename Hash>
+bool DictImage<Hash>::find(uint64_t hash, std::string_view word) const {
+    size_t bucket = bucketOf(hash, header_->bucketBits);
+    for (uint32_t i = bucketStarts_[bucket]; i < bucketStarts_[bucket + 1];
+         ++i) {
+        // only compare the words themselves if the full hashes agree
+        const Entry& entry = entries_[i];
+        if (entry.hash == hash
+            && std::string_view{strings_ + entry.offset, entry.length}
+                   == word) {
+            return true;
+        }
+    }
+    return false;
+}
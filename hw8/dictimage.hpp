@@ -0,0 +1,139 @@
+/**
+ * dictimage.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides DictImage<Hash>, a read-only dictionary that lives in a file.
+ * DictImage<Hash>::save writes the words of a HashSet<std::string> into a
+ * binary image: a header, one bucket offset per bucket, one entry (cached
+ * hash, string offset, length) per word, and then all the words' bytes.
+ * Everything is addressed by offsets from the start of the file, so the
+ * image is position-independent; opening one just maps the file into
+ * memory read-only (mmap), and lookups run directly against the mapped
+ * pages without parsing anything or allocating any strings.
+ *
+ * An image can only be searched with the hash function it was built with;
+ * the header records a check value so a mismatch is caught when it opens.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef DICTIMAGE_HPP_INCLUDED
+#define DICTIMAGE_HPP_INCLUDED
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+#include "hashset.hpp"
+#include "prefetch.hpp"
+
+template <typename Hash = MyHash>
+class DictImage {
+ public:
+    /* \brief Format version; images with any other version are refused
+     */
+    static constexpr uint32_t VERSION = 1;
+    /* \brief Number of words existsBatch prefetches at a time
+     */
+    static constexpr size_t BATCH_SIZE = 16;
+
+    /* \brief Writes the words in a set to an image file
+     * \param the set (any HashSet of std::string), the file to write, and
+     *        the hash object to build the image with
+     * \throws std::system_error if the file can't be written
+     * \note Takes Θ(n) time, where n is the number of words.
+     */
+    template <typename Set>
+    static void save(const Set& words, const std::string& filename,
+                     const Hash& hash = Hash());
+
+    /* \brief Maps an image file into memory
+     * \param the file to map, and the hash object it was built with
+     * \throws std::system_error if the file can't be opened or mapped, and
+     *         std::runtime_error if it isn't a valid image for this hash
+     * \note Takes Θ(1) time (pages are only read when a lookup needs them).
+     */
+    explicit DictImage(const std::string& filename, const Hash& hash = Hash());
+
+    DictImage(const DictImage& other) = delete;
+    DictImage& operator=(const DictImage& other) = delete;
+
+    /* \brief Destructor; unmaps the file
+     */
+    ~DictImage();
+
+    /* \brief Returns the number of words in the image
+     * \note Takes Θ(1) time.
+     */
+    size_t size() const;
+
+    /* \brief Returns the number of buckets in the image
+     * \note Takes Θ(1) time.
+     */
+    size_t buckets() const;
+
+    /* \brief Returns whether a word is in the image
+     * \note Takes Θ(1) expected time; compares hashes before any bytes.
+     */
+    bool exists(std::string_view word) const;
+
+    /* \brief Looks up a range of words at once, writing whether each one is
+     *        in the image to an output iterator (as HashSet::existsBatch
+     *        does, prefetching each window's buckets before searching them)
+     * \returns the output iterator, just past the last result written
+     */
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt existsBatch(ForwardIt first, ForwardIt last, OutputIt out) const;
+
+ private:
+    /* \brief The first bytes of every image file
+     */
+    struct Header {
+        char magic[8];           // "CS70DICT"
+        uint32_t version;        // VERSION
+        uint32_t byteOrder;      // BYTE_ORDER_MARK, as this machine wrote it
+        uint64_t hashCheck;      // the hash of HASH_CHECK_KEY
+        uint64_t numWords;       // words in the image
+        uint64_t bucketBits;     // log2 of the number of buckets
+        uint64_t entriesOffset;  // where the entries start
+        uint64_t stringsOffset;  // where the words' bytes start
+        uint64_t fileSize;       // total size, to catch truncated files
+    };
+
+    /* \brief One word: its cached hash and where its bytes are
+     */
+    struct Entry {
+        uint64_t hash;
+        uint32_t offset;  // from the start of the strings
+        uint32_t length;
+    };
+
+    static constexpr char MAGIC[8] = {'C', 'S', '7', '0', 'D', 'I', 'C', 'T'};
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr std::string_view HASH_CHECK_KEY = "CS70 dictionary image";
+
+    /* \brief Maps a hash value to a bucket (Fibonacci hashing, as in
+     *        RobinHoodTable)
+     */
+    static size_t bucketOf(uint64_t hash, uint64_t bucketBits);
+
+    /* \brief Looks for a word with a known hash
+     */
+    bool find(uint64_t hash, std::string_view word) const;
+
+    Hash hash_;                     // the hash the image was built with
+    const unsigned char* base_;     // start of the mapping
+    size_t mappedSize_;             // bytes mapped
+    const Header* header_;          // the header, at base_
+    const uint32_t* bucketStarts_;  // first entry of each bucket, plus end
+    const Entry* entries_;          // entries, grouped by bucket
+    const char* strings_;           // the words' bytes
+};
+
+#include "dictimage-private.hpp"
+
+#endif  // DICTIMAGE_HPP_INCLUDED
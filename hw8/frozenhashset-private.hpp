@@ -0,0 +1,331 @@
+/**
+ * frozenhashset-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements FrozenHashSet<T>, a set stored with a minimal perfect hash
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef FROZENHASHSET_HPP_INCLUDED
+#warning "Don't include this file directly. Include frozenhashset.hpp instead."
+#endif
+
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename Layout, typename SetHash>
+FrozenHashSet<T, Hash, KeyEqual>::FrozenHashSet(
+    const HashSet<T, Layout, SetHash, KeyEqual>& set, const Hash& hash,
+    const KeyEqual& equal)
+    : hash_{hash},
+      equal_{equal},
+      seed_{0},
+      attempts_{0},
+      numSlots_{0},
+      pilots_{},
+      remap_{},
+      values_{} {
+    values_.reserve(set.size());
+    // (an Arena set hands out std::string_views, hence the emplace)
+    set.forEach([this](const auto& value) { values_.emplace_back(value); });
+    build();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename InputIt>
+FrozenHashSet<T, Hash, KeyEqual>::FrozenHashSet(InputIt first, InputIt last,
+                                                const Hash& hash,
+                                                const KeyEqual& equal)
+    : hash_{hash},
+      equal_{equal},
+      seed_{0},
+      attempts_{0},
+      numSlots_{0},
+      pilots_{},
+      remap_{},
+      values_(first, last) {
+    build();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+uint64_t FrozenHashSet<T, Hash, KeyEqual>::scramble(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+uint64_t FrozenHashSet<T, Hash, KeyEqual>::mix(size_t hash) const {
+    return scramble(uint64_t(hash) ^ seed_);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::bucketFor(uint64_t mixed) const {
+    // Sends 60% of the elements to the first 30% of the buckets: a few big
+    // buckets are easy to place early on, and they leave more small ones
+    // (which are easy to place late) for when the table is nearly full
+    constexpr uint64_t RANGE = uint64_t(1) << 32;
+    constexpr uint64_t DENSE_SHARE = RANGE / 10 * 6;
+    uint64_t low = mixed & (RANGE - 1);
+    size_t dense = (pilots_.size() * 3 + 9) / 10;
+    if (low < DENSE_SHARE) {
+        return size_t(low * dense / DENSE_SHARE);
+    }
+    return dense
+           + size_t((low - DENSE_SHARE) * (pilots_.size() - dense)
+                    / (RANGE - DENSE_SHARE));
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::slotFor(uint64_t mixed,
+                                                 uint32_t pilot,
+                                                 size_t numSlots) {
+    // the pilot changes every bit of the result, so each pilot tried gives
+    // the bucket's elements a fresh, independent set of slots
+    uint64_t placed = scramble(mixed ^ (pilot * 0x9E3779B97F4A7C15ULL));
+    return size_t(((placed >> 32) * numSlots) >> 32);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::slotOf(uint64_t mixed) const {
+    size_t slot = slotFor(mixed, pilots_[bucketFor(mixed)], numSlots_);
+    // only about one element in a hundred needs the second step
+    return slot < values_.size() ? slot : remap_[slot - values_.size()];
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+void FrozenHashSet<T, Hash, KeyEqual>::build() {
+    if (values_.size() > UINT32_MAX) {
+        throw std::length_error("Too many elements for a FrozenHashSet");
+    }
+
+    // Hash everything once, sorted by hash so duplicates end up together
+    std::vector<std::pair<size_t, uint32_t>> keys;  // (hash, index)
+    keys.reserve(values_.size());
+    for (size_t i = 0; i < values_.size(); ++i) {
+        keys.emplace_back(hash_(values_[i]), uint32_t(i));
+    }
+    std::sort(keys.begin(), keys.end());
+    size_t numKeys = 0;
+    for (const auto& key : keys) {
+        if (numKeys > 0 && keys[numKeys - 1].first == key.first) {
+            if (equal_(values_[keys[numKeys - 1].second],
+                       values_[key.second])) {
+                continue;
+            }
+            // no pilot could ever send these two to different slots
+            throw std::invalid_argument(
+                "FrozenHashSet elements must have distinct hashes");
+        }
+        keys[numKeys++] = key;
+    }
+    keys.resize(numKeys);
+
+    // (at least two buckets, so there are some of each kind)
+    size_t numBuckets = std::max((numKeys + BUCKET_SIZE - 1) / BUCKET_SIZE,
+                                 size_t(2));
+    numSlots_ = std::max(size_t(std::ceil(numKeys / LOAD_FACTOR)), numKeys);
+    std::vector<uint64_t> mixed(numKeys);
+    std::vector<uint32_t> bucketStarts(numBuckets + 1);
+    std::vector<uint32_t> byBucket(numKeys);   // keys, grouped by bucket
+    std::vector<uint32_t> bySize(numBuckets);  // buckets, biggest first
+    std::vector<uint32_t> placedIn(numKeys);   // each key's slot
+    std::vector<bool> taken(numSlots_);
+    for (attempts_ = 1; attempts_ <= MAX_ATTEMPTS; ++attempts_) {
+        seed_ = attempts_ * 0x9E3779B97F4A7C15ULL;
+        pilots_.assign(numBuckets, 0);
+
+        // group the keys by bucket (a counting sort)
+        std::fill(bucketStarts.begin(), bucketStarts.end(), 0);
+        for (size_t i = 0; i < numKeys; ++i) {
+            mixed[i] = mix(keys[i].first);
+            ++bucketStarts[bucketFor(mixed[i]) + 1];
+        }
+        for (size_t b = 0; b < numBuckets; ++b) {
+            bucketStarts[b + 1] += bucketStarts[b];
+        }
+        std::vector<uint32_t> next(bucketStarts.begin(),
+                                   bucketStarts.end() - 1);
+        for (size_t i = 0; i < numKeys; ++i) {
+            byBucket[next[bucketFor(mixed[i])]++] = uint32_t(i);
+        }
+
+        // Place the biggest buckets first, while most slots are still free
+        for (size_t b = 0; b < numBuckets; ++b) {
+            bySize[b] = uint32_t(b);
+        }
+        std::stable_sort(bySize.begin(), bySize.end(),
+                         [&](uint32_t lhs, uint32_t rhs) {
+                             return bucketStarts[lhs + 1] - bucketStarts[lhs]
+                                    > bucketStarts[rhs + 1] - bucketStarts[rhs];
+                         });
+        std::fill(taken.begin(), taken.end(), false);
+        bool allPlaced = true;
+        for (uint32_t bucket : bySize) {
+            uint32_t begin = bucketStarts[bucket];
+            uint32_t end = bucketStarts[bucket + 1];
+            if (begin == end) {
+                // biggest first, so the rest are empty too
+                break;
+            }
+            bool placed = false;
+            for (uint32_t pilot = 0; pilot < MAX_PILOT_TRIES && !placed;
+                 ++pilot) {
+                uint32_t i = begin;
+                for (; i < end; ++i) {
+                    size_t slot = slotFor(mixed[byBucket[i]], pilot, numSlots_);
+                    if (taken[slot]) {
+                        break;
+                    }
+                    taken[slot] = true;
+                    placedIn[byBucket[i]] = uint32_t(slot);
+                }
+                placed = i == end;
+                if (!placed) {
+                    // give back the slots this pilot did get
+                    for (uint32_t j = begin; j < i; ++j) {
+                        taken[placedIn[byBucket[j]]] = false;
+                    }
+                } else {
+                    pilots_[bucket] = pilot;
+                }
+            }
+            if (!placed) {
+                // a seed that leaves a bucket this stuck is a bad one, so
+                // start over with the next
+                allPlaced = false;
+                break;
+            }
+        }
+
+        if (allPlaced) {
+            // Pair each slot past the end that was used with a free slot
+            // before the end (there are exactly as many of each)
+            remap_.assign(numSlots_ - numKeys, 0);
+            size_t freeSlot = 0;
+            for (size_t slot = numKeys; slot < numSlots_; ++slot) {
+                if (taken[slot]) {
+                    while (taken[freeSlot]) {
+                        ++freeSlot;
+                    }
+                    remap_[slot - numKeys] = uint32_t(freeSlot++);
+                }
+            }
+
+            // every key has its own slot, so move each element into it
+            std::vector<uint32_t> keyInSlot(numKeys);
+            for (size_t i = 0; i < numKeys; ++i) {
+                size_t slot = placedIn[i];
+                if (slot >= numKeys) {
+                    slot = remap_[slot - numKeys];
+                }
+                keyInSlot[slot] = keys[i].second;
+            }
+            std::vector<T> slots;
+            slots.reserve(numKeys);
+            for (uint32_t index : keyInSlot) {
+                slots.push_back(std::move(values_[index]));
+            }
+            values_.swap(slots);
+            return;
+        }
+    }
+    throw std::runtime_error("Couldn't find a perfect hash for these elements");
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K>
+bool FrozenHashSet<T, Hash, KeyEqual>::find(size_t hash, const K& key) const {
+    if (values_.empty()) {
+        return false;
+    }
+    return equal_(values_[slotOf(mix(hash))], key);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+bool FrozenHashSet<T, Hash, KeyEqual>::exists(const T& value) const {
+    return find(hash_(value), value);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename K, typename>
+bool FrozenHashSet<T, Hash, KeyEqual>::exists(const K& key) const {
+    return find(hash_(key), key);
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+template <typename ForwardIt, typename OutputIt>
+OutputIt FrozenHashSet<T, Hash, KeyEqual>::existsBatch(ForwardIt first,
+                                                       ForwardIt last,
+                                                       OutputIt out) const {
+    if (values_.empty()) {
+        for (; first != last; ++first, ++out) {
+            *out = false;
+        }
+        return out;
+    }
+    uint64_t mixed[BATCH_SIZE];
+    size_t slots[BATCH_SIZE];
+    while (first != last) {
+        // first pass: hash a window of keys and start loading their pilots
+        ForwardIt window = first;
+        size_t count = 0;
+        for (; count < BATCH_SIZE && first != last; ++count, ++first) {
+            mixed[count] = mix(hash_(*first));
+            prefetchForRead(&pilots_[bucketFor(mixed[count])]);
+        }
+        // second pass: find their slots and start loading those
+        for (size_t i = 0; i < count; ++i) {
+            slots[i] = slotOf(mixed[i]);
+            prefetchForRead(&values_[slots[i]]);
+        }
+        // third pass: compare
+        for (size_t i = 0; i < count; ++i, ++window) {
+            *out = bool(equal_(values_[slots[i]], *window));
+            ++out;
+        }
+    }
+    return out;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::size() const {
+    return values_.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::buckets() const {
+    return pilots_.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+double FrozenHashSet<T, Hash, KeyEqual>::bitsPerKey() const {
+    return values_.empty() ? 0.0
+                           : 32.0 * double(pilots_.size() + remap_.size())
+                                 / values_.size();
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+size_t FrozenHashSet<T, Hash, KeyEqual>::attempts() const {
+    return attempts_;
+}
+
+template <typename T, typename Hash, typename KeyEqual>
+std::ostream& FrozenHashSet<T, Hash, KeyEqual>::showStatistics(
+    std::ostream& out) const {
+    return out << buckets() << " pilots, " << bitsPerKey() << " bits per key"
+               << ", " << attempts() << " seeds tried" << std::endl;
+}
@@ -0,0 +1,192 @@
+/**
+ * frozenhashset.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides FrozenHashSet<T, Hash, KeyEqual>, a set that can't change once
+ * it is built, for dictionaries that are finished before they are searched.
+ * It holds its n elements in an array of exactly n slots, placed by a
+ * minimal perfect hash (CHD, "compress, hash and displace"): every element
+ * gets a slot of its own, so a lookup is one hash, one slot and one
+ * compare, with no chains, probing or collisions to pay for.
+ *
+ * The elements are split into small buckets by their hash.  Building the
+ * set finds each bucket a 32-bit pilot value, largest buckets first, such
+ * that mixing the pilot into the hashes of the bucket's elements sends
+ * them all to slots nobody has taken yet.  A lookup hashes the key, reads
+ * its bucket's pilot, and goes straight to the one slot the key could be
+ * in.  The pilots take 32 / BUCKET_SIZE bits per element.
+ *
+ * Finding pilots for the last few buckets gets slow as the table fills, so
+ * (as PTHash does) the pilots place the elements in a slightly larger
+ * table, with LOAD_FACTOR of its slots used; the few elements placed past
+ * the end are then redirected, through a small remapping array, to the
+ * slots left free before it.
+ *
+ * Elements whose full hash values are equal can't be told apart by any
+ * pilot, so the hash function must give distinct elements distinct hashes.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef FROZENHASHSET_HPP_INCLUDED
+#define FROZENHASHSET_HPP_INCLUDED
+
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "hashset.hpp"
+#include "prefetch.hpp"
+
+template <typename T, typename Hash = MyHash,
+          typename KeyEqual = std::equal_to<>>
+class FrozenHashSet {
+ public:
+    /* \brief Enables an overload only for transparent key types (as for
+     *        HashSet)
+     */
+    template <typename K>
+    using EnableIfTransparent = typename HashSet<
+        T, Chaining, Hash, KeyEqual>::template EnableIfTransparent<K>;
+
+    /* \brief Average number of elements in each pilot's bucket; bigger
+     *        buckets take fewer bits per element but longer to build
+     */
+    static constexpr size_t BUCKET_SIZE = 4;
+    /* \brief Fraction of the slots the pilots place elements in that are
+     *        used (the rest of the table, past the end, is remapped)
+     */
+    static constexpr double LOAD_FACTOR = 0.99;
+    /* \brief Number of keys existsBatch prefetches at a time
+     */
+    static constexpr size_t BATCH_SIZE = 16;
+
+    /* \brief Builds a frozen copy of a HashSet (of any layout)
+     * \param the set, and the hash and equality objects to use
+     * \throws std::invalid_argument if two elements have the same hash, and
+     *         std::length_error if there are 2^32 elements or more
+     * \note Takes Θ(n log n) expected time.
+     */
+    template <typename Layout, typename SetHash>
+    explicit FrozenHashSet(const HashSet<T, Layout, SetHash, KeyEqual>& set,
+                           const Hash& hash = Hash(),
+                           const KeyEqual& equal = KeyEqual());
+
+    /* \brief Builds a set from a range of elements (duplicates are dropped)
+     * \param the range, and the hash and equality objects to use
+     * \throws and takes time as for the other constructor
+     */
+    template <typename InputIt>
+    FrozenHashSet(InputIt first, InputIt last, const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual());
+
+    FrozenHashSet(const FrozenHashSet& other) = delete;
+    FrozenHashSet& operator=(const FrozenHashSet& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(n) time.
+     */
+    ~FrozenHashSet() = default;
+
+    /* \brief Returns the number of elements
+     * \note Takes Θ(1) time.
+     */
+    size_t size() const;
+
+    /* \brief Returns whether an item is in the set
+     * \param the item (or a transparent key) to search for
+     * \note Takes Θ(1) time: one hash, one pilot, one slot and one compare.
+     */
+    bool exists(const T&) const;
+    template <typename K, typename = EnableIfTransparent<K>>
+    bool exists(const K&) const;
+
+    /* \brief Looks up a range of items at once, writing whether each one is
+     *        in the set to an output iterator (as HashSet::existsBatch does,
+     *        prefetching each window's pilots and then its slots)
+     * \returns the output iterator, just past the last result written
+     */
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt existsBatch(ForwardIt first, ForwardIt last, OutputIt out) const;
+
+    /* \brief Returns the number of pilots (buckets)
+     */
+    size_t buckets() const;
+
+    /* \brief Returns the bits of index (pilots and remapping) per element,
+     *        not counting the elements themselves
+     */
+    double bitsPerKey() const;
+
+    /* \brief Returns how many seeds building the set tried before one
+     *        worked (almost always 1)
+     */
+    size_t attempts() const;
+
+    /* \brief Prints statistics about the set to a stream, in the style of
+     *        HashSet::showStatistics
+     */
+    std::ostream& showStatistics(std::ostream&) const;
+
+ private:
+    /* \brief Builds the perfect hash for values_ (which may contain
+     *        duplicates), leaving each element in its slot
+     */
+    void build();
+
+    /* \brief Number of seeds to try before giving up on building
+     */
+    static constexpr size_t MAX_ATTEMPTS = 16;
+
+    /* \brief Number of pilots to try for one bucket before giving up on
+     *        the seed (as PTHash does); even the last bucket placed still
+     *        has about one slot in a hundred free, so this is plenty
+     */
+    static constexpr uint32_t MAX_PILOT_TRIES = 4096;
+
+    /* \brief The MurmurHash3 finalizer, so every input bit affects every
+     *        output bit
+     */
+    static uint64_t scramble(uint64_t value);
+
+    /* \brief Mixes a hash with the seed
+     */
+    uint64_t mix(size_t hash) const;
+
+    /* \brief Returns the bucket (pilot) for a mixed hash
+     */
+    size_t bucketFor(uint64_t mixed) const;
+
+    /* \brief Returns the slot, out of numSlots, that a pilot sends a mixed
+     *        hash to
+     */
+    static size_t slotFor(uint64_t mixed, uint32_t pilot, size_t numSlots);
+
+    /* \brief Returns the slot an element with this mixed hash would be in
+     *        (following the remapping if need be)
+     */
+    size_t slotOf(uint64_t mixed) const;
+
+    /* \brief Looks for a key with a known hash in its only possible slot
+     */
+    template <typename K>
+    bool find(size_t hash, const K& key) const;
+
+    Hash hash_;                     // hashes the elements and keys
+    KeyEqual equal_;                // compares a key with its slot's element
+    uint64_t seed_;                 // mixed into every hash
+    size_t attempts_;               // seeds tried while building
+    size_t numSlots_;               // slots the pilots place elements in
+    std::vector<uint32_t> pilots_;  // one per bucket
+    std::vector<uint32_t> remap_;   // real slots for those past the end
+    std::vector<T> values_;         // the elements, each in its own slot
+};
+
+#include "frozenhashset-private.hpp"
+
+#endif  // FROZENHASHSET_HPP_INCLUDED
@@ -0,0 +1,243 @@
+/**
+ * hashbench.cpp
+ * Authors: Christian Johnson and Olivia Schleifer
+ *
+ * Measures every hash function in the hashInfo gallery (and myhash) on
+ * real word lists, so we can pick myhash from data: how fast each one is
+ * (GB/s and ns per key), and how evenly it spreads the distinct words over
+ * tables of several sizes (an occupancy histogram against the Poisson
+ * counts a random hash would give, chi-squared, and the longest chain).
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#include <cs70/stringhash.hpp>
+#include "wordfile.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+
+constexpr const char* DICT_FILE = "/home/student/data/smalldict.words";
+constexpr const char* CHECK_FILE = "/home/student/data/ispell.words";
+
+/**
+ * \brief A hash function to measure, and what to call it.
+ */
+struct NamedHash {
+    std::string name;
+    size_t (*function)(const std::string&);
+};
+
+/**
+ * \brief Print usage information for this program.
+ * \param progname The name of the program.
+ */
+void usage(const char* progname) {
+    std::cerr << "Usage: " << progname << " [options] [word-file ...]\n"
+              << "Options:\n"
+              << "  -h, --help             Print this message and exit.\n"
+              << "  -t, --time             Seconds to spend timing each hash "
+                 "(default 0.25).\n"
+              << "\nWith no files, measures the default dictionary and the "
+                 "default file\nto check:\n"
+              << "  " << DICT_FILE << "\n  " << CHECK_FILE << std::endl;
+}
+
+/**
+ * \brief Time a hash function over a list of words, hashing the whole list
+ *        as many times as fit in the time allowed, and report GB/s and
+ *        ns per key.
+ * \param hash The hash function.
+ * \param words The words to hash.
+ * \param numBytes The total length of the words.
+ * \param minSeconds How long to keep hashing for.
+ */
+void timeHash(const NamedHash& hash, const std::vector<std::string>& words,
+              size_t numBytes, double minSeconds) {
+    size_t passes = 0;
+    size_t combined = 0;  // used below, so the hashing can't be skipped
+    std::chrono::duration<double> secs{0};
+    auto startTime = std::chrono::high_resolution_clock::now();
+    do {
+        for (const auto& word : words) {
+            combined += hash.function(word);
+        }
+        ++passes;
+        secs = std::chrono::high_resolution_clock::now() - startTime;
+    } while (secs.count() < minSeconds);
+
+    double keys = double(words.size()) * passes;
+    std::cout << "  " << std::left << std::setw(24) << hash.name
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(8) << double(numBytes) * passes / secs.count() / 1e9
+              << " GB/s" << std::setprecision(2) << std::setw(9)
+              << secs.count() * 1e9 / keys << " ns/key"
+              << "   (checksum " << std::hex << (combined & 0xFFFF) << std::dec
+              << ")\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
+/**
+ * \brief Report how evenly a hash function spreads distinct words over a
+ *        table with a given number of buckets (using hash % buckets, as
+ *        ChainedTable does).
+ * \param hashes The hash of every distinct word.
+ * \param numBuckets The number of buckets.
+ */
+void showSpread(const std::vector<size_t>& hashes, size_t numBuckets) {
+    std::vector<size_t> counts(numBuckets, 0);
+    for (size_t hash : hashes) {
+        ++counts[hash % numBuckets];
+    }
+
+    // Histogram of bucket sizes, with everything from MAX_SHOWN up lumped
+    // together, next to what a random function would give (Poisson)
+    constexpr size_t MAX_SHOWN = 5;
+    std::vector<size_t> histogram(MAX_SHOWN + 1, 0);
+    size_t longest = 0;
+    double chiSquared = 0.0;
+    double load = double(hashes.size()) / numBuckets;
+    for (size_t count : counts) {
+        ++histogram[std::min(count, MAX_SHOWN)];
+        longest = std::max(longest, count);
+        chiSquared += (count - load) * (count - load) / load;
+    }
+    // For a random function, chi-squared averages buckets - 1 with standard
+    // deviation sqrt(2 (buckets - 1)), so this is about N(0, 1)
+    double degrees = double(numBuckets - 1);
+    double z = (chiSquared - degrees) / std::sqrt(2.0 * degrees);
+
+    std::cout << "    " << std::setw(9) << numBuckets << " buckets (load "
+              << std::setprecision(3) << load << "): chi-squared z "
+              << std::setprecision(3) << std::showpos << z << std::noshowpos
+              << ", longest chain " << longest << "\n      occupancy";
+    double poisson = std::exp(-load) * numBuckets;  // expected empty buckets
+    double expectedRest = double(numBuckets);
+    for (size_t size = 0; size <= MAX_SHOWN; ++size) {
+        double expected = size < MAX_SHOWN ? poisson : expectedRest;
+        std::cout << "  " << size << (size < MAX_SHOWN ? ":" : "+:")
+                  << histogram[size] << "/" << size_t(std::lround(expected));
+        expectedRest -= poisson;
+        poisson *= load / (size + 1);
+    }
+    std::cout << "  (actual/random)\n";
+}
+
+/**
+ * \brief Measure every hash function on the words of one file.
+ * \param filename The file.
+ * \param hashes The hash functions.
+ * \param minSeconds How long to spend timing each one.
+ */
+void benchmarkFile(const std::string& filename,
+                   const std::vector<NamedHash>& hashes, double minSeconds) {
+    WordFile file{filename};
+    std::vector<std::string> words(file.begin(), file.end());
+    if (words.empty()) {
+        std::cout << filename << ": no words to measure\n\n";
+        return;
+    }
+    size_t numBytes = 0;
+    for (const auto& word : words) {
+        numBytes += word.size();
+    }
+    std::vector<std::string_view> distinct(file.begin(), file.end());
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()),
+                   distinct.end());
+    std::cout << filename << ": " << words.size() << " words ("
+              << distinct.size() << " distinct), average length "
+              << std::setprecision(3) << double(numBytes) / words.size()
+              << "\n\n Throughput:\n";
+    for (const auto& hash : hashes) {
+        timeHash(hash, words, numBytes, minSeconds);
+    }
+
+    // Table sizes: ChainedTable's own sizes (10 doubled k times) at about
+    // four, one and a quarter words per bucket, and a power of two (where
+    // only the hash's low bits pick the bucket)
+    std::vector<size_t> sizes;
+    for (double load : {4.0, 1.0, 0.25}) {
+        size_t buckets = 10;
+        while (buckets * load < distinct.size()) {
+            buckets *= 2;
+        }
+        sizes.push_back(buckets);
+    }
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < distinct.size()) {
+        powerOfTwo *= 2;
+    }
+    sizes.push_back(powerOfTwo);
+
+    std::cout << "\n Spread of the distinct words:\n";
+    std::vector<size_t> hashValues(distinct.size());
+    for (const auto& hash : hashes) {
+        for (size_t i = 0; i < distinct.size(); ++i) {
+            hashValues[i] = hash.function(std::string{distinct[i]});
+        }
+        std::cout << "  " << hash.name << ":\n";
+        for (size_t buckets : sizes) {
+            showSpread(hashValues, buckets);
+        }
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * \brief Main program,
+ */
+int main(int argc, const char** argv) {
+    double minSeconds = 0.25;
+
+    std::list<std::string> args(argv + 1, argv + argc);
+    while (!args.empty() && args.front()[0] == '-') {
+        std::string option = args.front();
+        if (option == "-t" || option == "--time") {
+            args.pop_front();
+            if (args.empty()) {
+                std::cerr << "Option " << option << " needs a value\n";
+                return 1;
+            }
+            try {
+                minSeconds = std::stod(args.front());
+            } catch (std::invalid_argument& e) {
+                std::cerr << "Option " << option << " needs a number\n";
+                return 1;
+            }
+        } else if (option == "-h" || option == "--help") {
+            usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            usage(argv[0]);
+            return 1;
+        }
+        args.pop_front();
+    }
+    if (args.empty()) {
+        args = {DICT_FILE, CHECK_FILE};
+    }
+
+    // Everything in the gallery, plus myhash itself
+    std::vector<NamedHash> hashes;
+    for (const auto& [name, function] : hashInfo) {
+        hashes.push_back(NamedHash{name, function});
+    }
+    hashes.push_back(NamedHash{"myhash", myhash});
+
+    for (const auto& filename : args) {
+        benchmarkFile(filename, hashes, minSeconds);
+    }
+    return 0;
+}
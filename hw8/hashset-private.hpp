@@ -17,217 +17,842 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"      // FIXME: Remove soon.
 
 #include <iostream>
-#include <forward_list>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <stdexcept>
 #include <utility>
+#include <random>
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 #include <cmath>
 
-template <typename T>
-HashSet<T>::HashSet(size_t numBuckets, double maxLoadFactor)
-    : buckets_{new std::forward_list<T>[numBuckets]},
-      numBuckets_{numBuckets},
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+HashSet<T, Layout, Hash, KeyEqual>::HashSet(size_t numBuckets,
+                                            double maxLoadFactor,
+                                            const Hash& hash,
+                                            const KeyEqual& equal)
+    : hash_{hash},
+      equal_{equal},
+      table_{std::make_shared<Table>(numBuckets)},
+      oldTable_{nullptr},
+      migrated_{0},
+      incremental_{false},
       maxLoad_{maxLoadFactor},
+      minLoad_{maxLoadFactor / 4},
       size_{0},
       numHash_{0},
       collisions_{0},
-      maximal_{0} {
+      maximal_{0},
+      worstInsert_{0},
+      bloom_{nullptr},
+      bloomRejections_{0},
+      recordSearches_{true},
+      reseedSteps_{0},
+      reseedGuard_{0},
+      reseeds_{0} {
     // nothing needed here! everything initialized
 }
 
-template <typename T>
-void HashSet<T>::swap(HashSet<T>& other) {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::swap(
+    HashSet<T, Layout, Hash, KeyEqual>& other) {
     using std::swap;
-    // go through and call std::swap on all the data members
-    swap(buckets_, other.buckets_);
-    swap(numBuckets_, other.numBuckets_);
+    // go through and call swap on all the data members
+    swap(hash_, other.hash_);
+    swap(equal_, other.equal_);
+    swap(table_, other.table_);
+    swap(oldTable_, other.oldTable_);
+    swap(migrated_, other.migrated_);
+    swap(incremental_, other.incremental_);
     swap(maxLoad_, other.maxLoad_);
+    swap(minLoad_, other.minLoad_);
     swap(size_, other.size_);
+    swap(numHash_, other.numHash_);
+    swap(collisions_, other.collisions_);
+    swap(maximal_, other.maximal_);
+    swap(worstInsert_, other.worstInsert_);
+    swap(bloom_, other.bloom_);
+    swap(bloomRejections_, other.bloomRejections_);
+    swap(recordSearches_, other.recordSearches_);
+    swap(reseedSteps_, other.reseedSteps_);
+    swap(reseedGuard_, other.reseedGuard_);
+    swap(reseeds_, other.reseeds_);
 }
 
-template <typename T>
-HashSet<T>::~HashSet() {
-    // Returns private member variable
-    delete[] buckets_;
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+HashSet<T, Layout, Hash, KeyEqual>::~HashSet() {
+    // the tables go when the last set sharing them does
 }
 
-template <typename T>
-size_t HashSet<T>::size() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::size() const {
     // returns the size
     return size_;
 }
 
-template <typename T>
-void HashSet<T>::insert(const T& value) {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::insert(const T& value) {
+    insertHashed(hash_(value), value);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::insert(T&& value) {
+    insertHashed(hash_(value), std::move(value));
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename... Args>
+void HashSet<T, Layout, Hash, KeyEqual>::emplace(Args&&... args) {
+    // we need the value itself to hash it, so build it first, then move it
+    // into the table
+    T value(std::forward<Args>(args)...);
+    insertHashed(hash_(value), std::move(value));
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K, typename>
+void HashSet<T, Layout, Hash, KeyEqual>::insert(const K& key) {
+    // insertHashed only converts the key to a T if it has to store it
+    insertHashed(hash_(key), key);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename V>
+void HashSet<T, Layout, Hash, KeyEqual>::insertHashed(size_t hash, V&& value) {
+    size_t steps;
+    bool filtered;
     // checks if value is already in hash
-    if (!(insertExists(value))) {
-        // finds location with helper
-        size_t locationInsert = myhash(value) % numBuckets_;
-        if (!buckets_[locationInsert].empty()) {
+    bool found = find(hash, value, steps, filtered);
+    // an insert also counts the step that places the new value
+    noteSearch(steps + 1, filtered);
+    if (!found) {
+        unshare();
+        size_t bucketsBefore = table_->buckets();
+        if (table_->emplaceNew(hash, std::forward<V>(value))) {
             ++collisions_;
         }
-        // inserts value
-        buckets_[locationInsert].push_front(value);
+        noteOwnGrowth(bucketsBefore);
         ++size_;
-        if (loadFactor() > maxLoad_) {
-            rehash();
+        noteAdded(hash);
+        afterInsert();
+    }
+    // a run this long means the hash is doing badly on these keys, so
+    // start over with a new key (unless we did so only recently)
+    if constexpr (IsSeedable<Hash>::value) {
+        if (reseedSteps_ > 0 && steps + 1 > reseedSteps_
+            && size_ >= reseedGuard_) {
+            reseed();
+        }
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::erase(const T& value) {
+    return eraseHashed(hash_(value), value);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K, typename>
+bool HashSet<T, Layout, Hash, KeyEqual>::erase(const K& key) {
+    return eraseHashed(hash_(key), key);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K>
+bool HashSet<T, Layout, Hash, KeyEqual>::eraseHashed(size_t hash,
+                                                     const K& key) {
+    // a snapshot's table is only copied if there is something to erase
+    if (shared()) {
+        size_t steps;
+        bool filtered;
+        if (!find(hash, key, steps, filtered)) {
+            return false;
         }
+        unshare();
+    }
+    // while rehashing, the value may not have been migrated yet (and the
+    // Bloom filter can't forget it, but a stale bit only costs a search)
+    if (!table_->erase(hash, key, equal_)
+        && !(oldTable_ && oldTable_->erase(hash, key, equal_))) {
+        return false;
+    }
+    --size_;
+    shrinkIfNeeded();
+    return true;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::shrinkIfNeeded() {
+    if (loadFactor() >= minLoad_) {
+        return;
+    }
+    // rebuilt half full, it can take as many inserts as erases before it
+    // has to change size again
+    size_t numBuckets = bucketsFor(2 * size_);
+    if (numBuckets * 2 > table_->buckets()) {
+        return;
+    }
+    rehashTo(numBuckets);
+    // a fresh filter forgets the erased values too
+    if (bloom_) {
+        rebuildBloomFilter(std::max(size_, table_->buckets()),
+                           bloom_->falsePositiveRate());
     }
 }
 
-template <typename T>
-void HashSet<T>::newInsert(const T& value) {
-    // finds location with helper
-    size_t locationInsert = myhash(value) % numBuckets_;
-    // inserts value
-    buckets_[locationInsert].push_front(value);
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::newInsert(const T& value) {
+    // inserts value without looking for it first
+    size_t hash = hash_(value);
+    unshare();
+    size_t bucketsBefore = table_->buckets();
+    table_->emplaceNew(hash, value);
+    noteOwnGrowth(bucketsBefore);
     ++size_;
+    noteAdded(hash);
+    afterInsert();
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::exists(const T& value) const {
+    size_t steps;
+    bool filtered;
+    bool found = find(hash_(value), value, steps, filtered);
+    // steps keeps track of how far we searched and updates maximal_
+    noteLookup(steps, filtered);
+    return found;
 }
 
-template <typename T>
-bool HashSet<T>::exists(const T& value) const {
-    // uses myhash function and current number of buckets to find correct bucket
-    size_t locationCheck = myhash(value) % numBuckets_;
-    size_t count = 0;
-    for (auto i = buckets_[locationCheck].begin();
-         i != buckets_[locationCheck].end(); ++i) {
-        ++count;
-        // count keeps track of length of bucket and updates maximal_
-        // accordingly
-        if (*i == value) {
-            if (count > maximal_) {
-                maximal_ = count;
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K, typename>
+bool HashSet<T, Layout, Hash, KeyEqual>::exists(const K& key) const {
+    size_t steps;
+    bool filtered;
+    bool found = find(hash_(key), key, steps, filtered);
+    noteLookup(steps, filtered);
+    return found;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename ForwardIt, typename OutputIt>
+OutputIt HashSet<T, Layout, Hash, KeyEqual>::existsBatch(ForwardIt first,
+                                                         ForwardIt last,
+                                                         OutputIt out) const {
+    using K = std::decay_t<decltype(*first)>;
+    static_assert(std::is_same_v<K, T>
+                      || (IsTransparentKey<T, K>::value
+                          && IsTransparent<Hash>::value
+                          && IsTransparent<KeyEqual>::value),
+                  "existsBatch needs a range of Ts or transparent keys");
+    size_t hashes[BATCH_SIZE];
+    while (first != last) {
+        // first pass: hash a window of keys and start loading what each
+        // search will read first
+        ForwardIt window = first;
+        size_t count = 0;
+        for (; count < BATCH_SIZE && first != last; ++count, ++first) {
+            hashes[count] = hash_(*first);
+            if (bloom_) {
+                bloom_->prefetch(hashes[count]);
+            } else {
+                table_->prefetch(hashes[count]);
             }
-            return true;
+        }
+        // second pass: by now most of that memory should have arrived
+        for (size_t i = 0; i < count; ++i, ++window) {
+            size_t steps;
+            bool filtered;
+            *out = find(hashes[i], *window, steps, filtered);
+            ++out;
+            noteLookup(steps, filtered);
         }
     }
-    if (count > maximal_) {
-        maximal_ = count;
-    }
-    return false;
-}
-
-template <typename T>
-bool HashSet<T>::insertExists(const T& value) const {
-    // uses myhash function and current number of buckets to find correct bucket
-    size_t locationCheck = myhash(value) % numBuckets_;
-    size_t count = 1;
-    // count keeps track of length of bucket and updates maximal_
-    // accordingly
-    for (auto i = buckets_[locationCheck].begin();
-         i != buckets_[locationCheck].end(); ++i) {
-        ++count;
-        if (*i == value) {
-            if (count > maximal_) {
-                maximal_ = count;
-            }
-            return true;
+    return out;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename K>
+bool HashSet<T, Layout, Hash, KeyEqual>::find(size_t hash, const K& key,
+                                              size_t& steps,
+                                              bool& filtered) const {
+    // a definite "no" from the filter saves touching the table at all
+    filtered = bloom_ && !bloom_->mayContain(hash);
+    if (filtered) {
+        steps = 0;
+        return false;
+    }
+    if (table_->contains(hash, key, equal_, steps)) {
+        return true;
+    }
+    // buckets not yet migrated still hold their elements in the old table
+    size_t oldSteps = 0;
+    bool found =
+        oldTable_ && oldTable_->contains(hash, key, equal_, oldSteps);
+    steps += oldSteps;
+    return found;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::unshare() {
+    if (table_.use_count() > 1 || (oldTable_ && oldTable_.use_count() > 1)) {
+        // the cached hashes mean we never need to call hash_ again, and the
+        // copy may as well take the old table's elements too, rather than
+        // go on migrating them
+        auto copy = std::make_shared<Table>(table_->buckets());
+        auto add = [&copy](size_t hash, const auto& value) {
+            copy->emplaceNew(hash, value);
+        };
+        table_->forEach(add);
+        if (oldTable_) {
+            oldTable_->forEach(add);
+            oldTable_.reset();
+            migrated_ = 0;
         }
+        table_ = std::move(copy);
+    }
+    if (bloom_ && bloom_.use_count() > 1) {
+        bloom_ = std::make_shared<BloomFilter>(*bloom_);
+    }
+    // A count of one may come from another thread having just dropped its
+    // copy; the count is read relaxed, so make sure that thread's last
+    // reads of the tables happen before our writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::noteAdded(size_t hash) {
+    if (!bloom_) {
+        return;
     }
-    if (count > maximal_) {
-        maximal_ = count;
+    // past its capacity the filter's false-positive rate climbs, so double it
+    if (size_ > bloom_->capacity()) {
+        rebuildBloomFilter(size_ * 2, bloom_->falsePositiveRate());
+    } else {
+        bloom_->add(hash);
     }
-    return false;
 }
 
-template <typename T>
-std::ostream& HashSet<T>::printToStream(std::ostream& out) const {
-    for (size_t val = 0; val < numBuckets_; ++val) {
-        out << "[";
-        out << val;
-        out << "]";
-        for (auto item = buckets_[val].begin(); item != buckets_[val].end();
-             ++item) {
-            // prints ", " unless at beginning of the current bucket
-            if (!(item == buckets_[val].begin())) {
-                out << ", ";
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::rebuildBloomFilter(
+    size_t capacity, double falsePositiveRate) {
+    // a new filter, so any copy sharing the old one keeps it
+    bloom_ = std::make_shared<BloomFilter>(capacity, falsePositiveRate);
+    // the cached hashes mean we never need to call hash_ again
+    auto add = [this](size_t hash, const auto&) { bloom_->add(hash); };
+    table_->forEach(add);
+    if (oldTable_) {
+        oldTable_->forEach(add);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::useBloomFilter(
+    double falsePositiveRate) {
+    if (falsePositiveRate == 0.0) {
+        bloom_.reset();
+        return;
+    }
+    // sized for what is there now; inserts past that double it
+    rebuildBloomFilter(std::max(size_, table_->buckets()), falsePositiveRate);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+double HashSet<T, Layout, Hash, KeyEqual>::bloomFalsePositiveRate() const {
+    return bloom_ ? bloom_->falsePositiveRate() : 0.0;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::bloomRejections() const {
+    return bloomRejections_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::noteSearch(size_t steps,
+                                                    bool filtered) const {
+    if (steps > maximal_) {
+        maximal_ = steps;
+    }
+    if (filtered) {
+        ++bloomRejections_;
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::noteLookup(size_t steps,
+                                                    bool filtered) const {
+    // with recording off, lookups must not write to the set at all
+    if (recordSearches_) {
+        noteSearch(steps, filtered);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::afterInsert() {
+    size_t moved = migrate(MIGRATION_STEP) + growIfNeeded();
+    if (moved > worstInsert_) {
+        worstInsert_ = moved;
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::migrate(size_t numBuckets) {
+    if (!oldTable_) {
+        return 0;
+    }
+    size_t moved = 0;
+    size_t stop = std::min(migrated_ + numBuckets, oldTable_->buckets());
+    for (; migrated_ < stop; ++migrated_) {
+        size_t bucketsBefore = table_->buckets();
+        moved += oldTable_->transferBucket(migrated_, *table_);
+        noteOwnGrowth(bucketsBefore);
+    }
+    // once every bucket has been moved, the old table can go
+    if (migrated_ == oldTable_->buckets()) {
+        oldTable_.reset();
+    }
+    return moved;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::noteOwnGrowth(size_t bucketsBefore) {
+    // the Cuckoo layout grows by itself when displacing elements fails
+    if (table_->buckets() != bucketsBefore) {
+        ++numHash_;
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::growIfNeeded() {
+    // open-addressed layouts must never fill up, whatever the client asked
+    if (loadFactor() <= std::min(maxLoad_, Table::MAX_LOAD_LIMIT)) {
+        return 0;
+    }
+    if (!incremental_) {
+        rehash();
+        return size_;
+    }
+    // finish any earlier migration (rare: each insert moves several buckets)
+    size_t moved = oldTable_ ? migrate(oldTable_->buckets()) : 0;
+    // the current table becomes the old one, to be drained a bit at a time
+    oldTable_ = std::move(table_);
+    table_ = std::make_shared<Table>(oldTable_->buckets() * 2);
+    migrated_ = 0;
+    ++numHash_;
+    return moved;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename F>
+void HashSet<T, Layout, Hash, KeyEqual>::forEach(F&& fn) const {
+    auto visit = [&fn](size_t, const auto& value) { fn(value); };
+    table_->forEach(visit);
+    // elements still waiting to be migrated are in the old table
+    if (oldTable_) {
+        oldTable_->forEach(visit);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator
+HashSet<T, Layout, Hash, KeyEqual>::begin() const {
+    // elements still waiting to be migrated come after the new table's
+    return const_iterator{table_->begin(), table_->end(), oldTable_.get()};
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator
+HashSet<T, Layout, Hash, KeyEqual>::end() const {
+    const Table& last = oldTable_ ? *oldTable_ : *table_;
+    return const_iterator{last.end(), last.end(), nullptr};
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::vector<typename HashSet<T, Layout, Hash, KeyEqual>::BucketRange>
+HashSet<T, Layout, Hash, KeyEqual>::bucketRanges(size_t count) const {
+    // old buckets already migrated are empty, so they aren't counted
+    size_t total = table_->buckets();
+    if (oldTable_) {
+        total += oldTable_->buckets() - migrated_;
+    }
+    size_t perRange = (total + std::max(count, size_t(1)) - 1)
+                      / std::max(count, size_t(1));
+
+    std::vector<BucketRange> ranges;
+    auto split = [&ranges, perRange](const Table& table, size_t first) {
+        for (size_t start = first; start < table.buckets(); start += perRange) {
+            // the last run takes anything past the last bucket (the
+            // cuckoo stash)
+            size_t stop = start + perRange;
+            auto last =
+                stop < table.buckets() ? table.begin(stop) : table.end();
+            ranges.push_back(
+                BucketRange{const_iterator{table.begin(start), last, nullptr},
+                            const_iterator{last, last, nullptr}});
+        }
+    };
+    split(*table_, 0);
+    if (oldTable_) {
+        split(*oldTable_, migrated_);
+    }
+    return ranges;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename F>
+void HashSet<T, Layout, Hash, KeyEqual>::parallelForEach(F&& fn,
+                                                         size_t threads) const {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    // a few runs per thread, handed out as threads finish, so that one
+    // crowded run doesn't leave the others waiting
+    std::vector<BucketRange> ranges = bucketRanges(threads * 4);
+    std::atomic<size_t> nextRange{0};
+    std::exception_ptr failure;
+    std::mutex failureLock;
+    auto work = [&]() {
+        try {
+            for (size_t i = nextRange++; i < ranges.size(); i = nextRange++) {
+                for (const auto& value : ranges[i]) {
+                    fn(value);
+                }
+            }
+        } catch (...) {
+            // keep the first exception, and stop handing out runs
+            std::lock_guard<std::mutex> guard{failureLock};
+            if (!failure) {
+                failure = std::current_exception();
             }
-            out << *item;
+            nextRange = ranges.size();
         }
-        out << "\n";
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+        workers.emplace_back(work);
+    }
+    // this thread does a share of the work too
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+HashSet<T, Layout, Hash, KeyEqual>::const_iterator::const_iterator(
+    TableIterator current, TableIterator stop, const Table* next)
+    : current_{current}, stop_{stop}, next_{next} {
+    skipToNextTable();
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::const_iterator::skipToNextTable() {
+    if (current_ == stop_ && next_) {
+        current_ = next_->begin();
+        stop_ = next_->end();
+        next_ = nullptr;
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator::reference
+HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator*() const {
+    return *current_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename R, typename>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator::pointer
+HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator->() const {
+    return std::addressof(*current_);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator&
+HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator++() {
+    ++current_;
+    skipToNextTable();
+    return *this;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator
+HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator++(int) {
+    const_iterator before = *this;
+    ++*this;
+    return before;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator==(
+    const const_iterator& other) const {
+    // the end of a run is just a position, wherever the iterator goes next
+    return current_ == other.current_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::const_iterator::operator!=(
+    const const_iterator& other) const {
+    return !(*this == other);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+HashSet<T, Layout, Hash, KeyEqual>::BucketRange::BucketRange(
+    const_iterator first, const_iterator last)
+    : first_{first}, last_{last} {
+    // nothing else to do
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator
+HashSet<T, Layout, Hash, KeyEqual>::BucketRange::begin() const {
+    return first_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+typename HashSet<T, Layout, Hash, KeyEqual>::const_iterator
+HashSet<T, Layout, Hash, KeyEqual>::BucketRange::end() const {
+    return last_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::ostream& HashSet<T, Layout, Hash, KeyEqual>::printToStream(
+    std::ostream& out) const {
+    table_->printToStream(out);
+    // elements still waiting to be migrated are shown after the new table
+    if (oldTable_) {
+        out << "(still rehashing, old table follows)\n";
+        oldTable_->printToStream(out);
     }
     return out;
 }
 
-template <typename T>
-void HashSet<T>::maxLoadFactor(double newMaxLoadFactor) {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::maxLoadFactor(
+    double newMaxLoadFactor) {
     // sets maxLoadFactor to new value
     maxLoad_ = newMaxLoadFactor;
 }
 
-template <typename T>
-double HashSet<T>::getMaxLoad() {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+double HashSet<T, Layout, Hash, KeyEqual>::getMaxLoad() {
     // gets the maxLoadFactor
     return maxLoad_;
 }
 
-template <typename T>
-void HashSet<T>::rehash() {
-    // make new empty hash with load half the size of maxLoad
-    HashSet<T> newHash{numBuckets_ * 2, maxLoad_};
-    // put all the values from the old hash into the new one
-    for (size_t val = 0; val < numBuckets_; ++val) {
-        for (auto item = buckets_[val].begin(); item != buckets_[val].end();
-             ++item) {
-            newHash.newInsert(*item);
-        }
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::minLoadFactor(
+    double newMinLoadFactor) {
+    minLoad_ = newMinLoadFactor;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+double HashSet<T, Layout, Hash, KeyEqual>::getMinLoad() const {
+    return minLoad_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::rehash() {
+    // make new empty table twice the size
+    rehashTo(table_->buckets() * 2);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::rehashTo(size_t numBuckets) {
+    unshare();
+    if (oldTable_) {
+        migrate(oldTable_->buckets());
+    }
+    auto newTable = std::make_shared<Table>(numBuckets);
+    // the layout may round the size to what it is already
+    if (newTable->buckets() == table_->buckets()) {
+        return;
+    }
+    // move all the values from the old table into the new one
+    for (size_t val = 0; val < table_->buckets(); ++val) {
+        table_->transferBucket(val, *newTable);
     }
-    // swap the old and new hashes
-    swap(newHash);
+    // swap the old and new tables
+    table_ = std::move(newTable);
     ++numHash_;
 }
 
-template <typename T>
-size_t HashSet<T>::buckets() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::bucketsFor(
+    size_t numElements) const {
+    // the same limit growIfNeeded enforces
+    double maxLoad = std::min(maxLoad_, Table::MAX_LOAD_LIMIT);
+    return std::max(size_t(std::ceil(numElements / maxLoad)), size_t(1));
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::reserve(size_t numElements) {
+    size_t numBuckets = bucketsFor(numElements);
+    if (numBuckets > table_->buckets()) {
+        rehashTo(numBuckets);
+    }
+    // a filter that small would have to be rebuilt along the way
+    if (bloom_ && numElements > bloom_->capacity()) {
+        rebuildBloomFilter(numElements, bloom_->falsePositiveRate());
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::shrinkToFit() {
+    size_t numBuckets = bucketsFor(size_);
+    if (numBuckets < table_->buckets()) {
+        rehashTo(numBuckets);
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::incrementalRehash(bool incremental) {
+    incremental_ = incremental;
+    // turning it off shouldn't leave a half-finished migration behind
+    if (!incremental_ && oldTable_) {
+        unshare();
+        // (unsharing may already have taken in the old table's elements)
+        if (oldTable_) {
+            migrate(oldTable_->buckets());
+        }
+    }
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void HashSet<T, Layout, Hash, KeyEqual>::recordSearches(bool record) {
+    recordSearches_ = record;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename H, typename>
+void HashSet<T, Layout, Hash, KeyEqual>::reseed() {
+    std::random_device random;
+    hash_.reseed((uint64_t(random()) << 32) ^ random());
+    // the cached hashes were made with the old key, so hash every element
+    // again into a new table of the same size
+    // (copying, not moving, so a copy sharing the tables keeps them)
+    auto newTable = std::make_shared<Table>(table_->buckets());
+    auto add = [this, &newTable](size_t, const auto& value) {
+        newTable->emplaceNew(hash_(value), value);
+    };
+    table_->forEach(add);
+    if (oldTable_) {
+        oldTable_->forEach(add);
+        oldTable_.reset();
+        migrated_ = 0;
+    }
+    table_ = std::move(newTable);
+    if (bloom_) {
+        rebuildBloomFilter(bloom_->capacity(), bloom_->falsePositiveRate());
+    }
+    // the runs that caused this are gone
+    maximal_ = 0;
+    reseedGuard_ = size_ + size_ / 4 + 1;
+    ++reseeds_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+template <typename H, typename>
+void HashSet<T, Layout, Hash, KeyEqual>::reseedAfter(size_t steps) {
+    reseedSteps_ = steps;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::reseeds() const {
+    return reseeds_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::rehashing() const {
+    return bool(oldTable_);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+bool HashSet<T, Layout, Hash, KeyEqual>::shared() const {
+    // a copy holds the same tables until one of the two sets changes
+    return table_.use_count() > 1
+           || (oldTable_ && oldTable_.use_count() > 1)
+           || (bloom_ && bloom_.use_count() > 1);
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::buckets() const {
     // returns the number of buckets in the hash table
-    return numBuckets_;
+    return table_->buckets();
 }
 
-template <typename T>
-double HashSet<T>::loadFactor() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+double HashSet<T, Layout, Hash, KeyEqual>::loadFactor() const {
     // returns the load factor
     // checks if dividing by 0
-    if (numBuckets_ == 0) {
+    if (table_->buckets() == 0) {
         return 0;
     }
-    return double(size_) / numBuckets_;
+    return double(size_) / table_->buckets();
 }
 
-template <typename T>
-size_t HashSet<T>::reallocations() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::reallocations() const {
     // Return the number of times the table has been rehashed
     return numHash_;
 }
 
-template <typename T>
-size_t HashSet<T>::collisions() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::collisions() const {
     // returns the number of times we inserted into a non-empty bucket
     return collisions_;
 }
 
-template <typename T>
-size_t HashSet<T>::maximal() const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::maximal() const {
     // returns the longest run in the hash set
     return maximal_;
 }
 
-template <typename T>
-std::ostream& HashSet<T>::showStatistics(std::ostream& out) const {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+size_t HashSet<T, Layout, Hash, KeyEqual>::worstInsert() const {
+    // returns the most elements any one insert had to move
+    return worstInsert_;
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::ostream& HashSet<T, Layout, Hash, KeyEqual>::showStatistics(
+    std::ostream& out) const {
     // reallocations() counts expansions
-    return out << reallocations() << " expansions"
+    out << reallocations() << " expansions"
                << ", "
                // loadFactor() calculates the load factor
                // collisions() gets the collisions member variable
                << "load factor " << loadFactor() << ", " << collisions()
                << " collisions"
                << ", "
-               // maximal() counts the longest bucket
-               << "longest run " << maximal() << std::endl;
+               // maximal() counts the longest bucket or probe sequence
+               << "longest run " << maximal() << ", "
+               // worstInsert() is the most rehashing work done by an insert
+               << "worst insert moved " << worstInsert();
+    // only sets with a Bloom filter have anything to say about it
+    if (bloom_) {
+        out << ", Bloom filter rejected " << bloomRejections() << " searches";
+    }
+    // nor do sets that never reseed
+    if (reseedSteps_ > 0) {
+        out << ", " << reseeds() << " reseeds";
+    }
+    return out << std::endl;
 }
 
-template <typename T>
-std::ostream& operator<<(std::ostream& out, const HashSet<T>& hashSet) {
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::ostream& operator<<(std::ostream& out,
+                         const HashSet<T, Layout, Hash, KeyEqual>& hashSet) {
     // overrides print operator
     return hashSet.printToStream(out);
 }
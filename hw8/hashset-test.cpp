@@ -6,11 +6,34 @@
 // Make sure you define these functions *before* HashSet gets included
 
 #include <string>
+#include <string_view>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include "stringhash-extra.hpp"  // declares the string_view overload
 size_t myhash(const int& integer);
 size_t myhash(const std::string& str);
 #include "hashset.hpp"
+#include "dictimage.hpp"
+#include "concurrenthashset.hpp"
+#include "frozenhashset.hpp"
+#include "wordfile.hpp"
+#include "wordstream.hpp"
 
 size_t myhash(const std::string& str) {
+    return myhash(std::string_view{str});
+}
+
+size_t myhash(std::string_view str) {
     size_t hash = 0;
     size_t i = 0;
 
@@ -33,6 +56,102 @@ size_t myhash(const int& integer) {
     return hash;
 }
 
+/// A key type that counts how many times it has been hashed
+struct Counted {
+    int id;
+    static size_t hashes;
+};
+size_t Counted::hashes = 0;
+
+bool operator==(const Counted& lhs, const Counted& rhs) {
+    return lhs.id == rhs.id;
+}
+
+std::ostream& operator<<(std::ostream& out, const Counted& c) {
+    return out << c.id;
+}
+
+size_t myhash(const Counted& c) {
+    ++Counted::hashes;
+    return myhash(c.id);
+}
+
+/// A key type that counts how many times it has been copied
+struct CopyCounter {
+    explicit CopyCounter(int i) : id{i} {
+    }
+    CopyCounter(const CopyCounter& other) : id{other.id} {
+        ++copies;
+    }
+    CopyCounter(CopyCounter&& other) = default;
+    CopyCounter& operator=(const CopyCounter& other) = delete;
+    CopyCounter& operator=(CopyCounter&& other) = default;
+
+    int id;
+    static size_t copies;
+};
+size_t CopyCounter::copies = 0;
+
+bool operator==(const CopyCounter& lhs, const CopyCounter& rhs) {
+    return lhs.id == rhs.id;
+}
+
+std::ostream& operator<<(std::ostream& out, const CopyCounter& c) {
+    return out << c.id;
+}
+
+size_t myhash(const CopyCounter& c) {
+    return myhash(c.id);
+}
+
+/// Hash policy that ignores case (and so agrees with NoCaseEqual)
+struct NoCaseHash {
+    size_t operator()(const std::string& str) const {
+        std::string lower = str;
+        for (char& ch : lower) {
+            ch = std::tolower(static_cast<unsigned char>(ch));
+        }
+        return myhash(lower);
+    }
+};
+
+/// Equality policy that ignores case
+struct NoCaseEqual {
+    bool operator()(const std::string& lhs, const std::string& rhs) const {
+        if (lhs.size() != rhs.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < lhs.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(lhs[i]))
+                != std::tolower(static_cast<unsigned char>(rhs[i]))) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+/// Seedable hash policy that sends every key to the same bucket until it
+/// is reseeded, like a hash someone has found collisions for.  It counts
+/// its reseeds rather than taking the set's random keys, so the probe
+/// lengths a test sees are the same every run.
+struct CollideUntilReseeded {
+    using is_transparent = void;
+
+    void reseed(uint64_t) {
+        keyed.reseed(++generation);
+        seeded = true;
+    }
+
+    size_t operator()(std::string_view str) const {
+        return seeded ? keyed(str) : 42;
+    }
+
+    SipHash keyed{0};
+    uint64_t generation = 0;
+    bool seeded = false;
+};
+
 ///////////////////////////////////////////////////////////
 //  TESTING
 ///////////////////////////////////////////////////////////
@@ -211,7 +330,1514 @@ bool collisionsTest() {
     myHash.showStatistics(ss);
     affirm_expected(
         ss.str(),
-        "0 expansions, load factor 26, 25 collisions, longest run 26\n");
+        "0 expansions, load factor 26, 25 collisions, longest run 26, "
+        "worst insert moved 0\n");
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the open-addressing (Robin Hood) layout
+ */
+bool robinHoodTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"07 robin hood layout (insert, exists, rehash)"};
+
+    // the slot count is rounded up to a power of two
+    using RobinHoodSet = HashSet<int, RobinHood>;
+    RobinHoodSet myHash(10);
+    affirm_expected(myHash.buckets(), 16);
+
+    for (int i = 1; i <= 100; ++i) {
+        myHash.insert(i);
+    }
+    // inserting a duplicate doesn't change the size
+    myHash.insert(50);
+    affirm_expected(myHash.size(), 100);
+
+    bool allFound = true;
+    for (int i = 1; i <= 100; ++i) {
+        allFound = allFound && myHash.exists(i);
+    }
+    affirm(allFound);
+    affirm(!myHash.exists(0));
+    affirm(!myHash.exists(101));
+
+    // the table never gets fuller than the default load factor allows
+    affirm(myHash.loadFactor() <= RobinHoodSet::DEFAULT_MAX_LOAD_FACTOR);
+    affirm(myHash.reallocations() > 0);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks that rehashing uses the cached hash values
+ *         instead of hashing every element again
+ */
+bool cachedHashTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"08 cached hashes (rehash never calls myhash)"};
+
+    HashSet<Counted> chained(1, 1.0);
+    HashSet<Counted, RobinHood> robinHood(1);
+    Counted::hashes = 0;
+    for (int i = 0; i < 64; ++i) {
+        chained.insert(Counted{i});
+        robinHood.insert(Counted{i});
+    }
+    // one hash per insert, even though both tables grew several times
+    affirm(chained.reallocations() > 0);
+    affirm(robinHood.reallocations() > 0);
+    affirm_expected(Counted::hashes, 128);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks incremental rehashing, which spreads the work of
+ *         growing the table over later inserts
+ */
+bool incrementalRehashTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"09 incremental rehash (rehashing, worstInsert)"};
+
+    HashSet<std::string> stopTheWorld(4, 1.0);
+    HashSet<std::string> incremental(4, 1.0);
+    HashSet<std::string, RobinHood> flat(4);
+    incremental.incrementalRehash(true);
+    flat.incrementalRehash(true);
+
+    bool sawRehashing = false;
+    for (int i = 0; i < 1000; ++i) {
+        std::string word = std::to_string(i);
+        stopTheWorld.insert(word);
+        incremental.insert(word);
+        flat.insert(word);
+        sawRehashing = sawRehashing || incremental.rehashing();
+    }
+    affirm(sawRehashing);
+    affirm_expected(incremental.size(), 1000);
+    affirm_expected(flat.size(), 1000);
+    affirm_expected(incremental.reallocations(), stopTheWorld.reallocations());
+
+    // everything is still findable, whichever table it is in right now
+    bool allFound = true;
+    for (int i = 0; i < 1000; ++i) {
+        std::string word = std::to_string(i);
+        allFound = allFound && incremental.exists(word) && flat.exists(word);
+    }
+    affirm(allFound);
+    affirm(!incremental.exists("1000"));
+    affirm(!flat.exists("-1"));
+
+    // growing all at once moves every element in one insert; incrementally
+    // each insert only moves a few buckets' worth
+    affirm(stopTheWorld.worstInsert() >= 512);
+    affirm(incremental.worstInsert() < 100);
+    affirm(flat.worstInsert() < 100);
+
+    // turning it off finishes the migration
+    incremental.incrementalRehash(false);
+    affirm(!incremental.rehashing());
+    affirm(incremental.exists("999"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks move insertion, emplace, and that rehashing
+ *         relinks (or moves) elements rather than copying them
+ */
+bool moveAndEmplaceTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"10 insert(T&&) and emplace (no copies)"};
+
+    HashSet<std::string> words;
+    std::string word = "llama";
+    words.insert(std::move(word));
+    affirm(words.exists("llama"));
+
+    // a duplicate isn't moved from, since it wasn't inserted
+    std::string again = "llama";
+    words.insert(std::move(again));
+    affirm_expected(again, "llama");
+    affirm_expected(words.size(), 1);
+
+    words.emplace(3, 'z');
+    affirm(words.exists("zzz"));
+    words.emplace("zzz");
+    affirm_expected(words.size(), 2);
+
+    HashSet<CopyCounter> chained(1, 1.0);
+    HashSet<CopyCounter, RobinHood> robinHood(1);
+    CopyCounter::copies = 0;
+    for (int i = 0; i < 100; ++i) {
+        chained.emplace(i);
+        robinHood.insert(CopyCounter{i});
+    }
+    // both tables grew many times without copying a single element
+    affirm(chained.reallocations() > 0);
+    affirm(robinHood.reallocations() > 0);
+    affirm_expected(CopyCounter::copies, 0);
+    affirm(chained.exists(CopyCounter{42}));
+    affirm(robinHood.exists(CopyCounter{42}));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks lookups and inserts with keys that aren't
+ *         std::strings (string views and C strings)
+ */
+bool transparentKeyTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"11 transparent keys (string_view, const char*)"};
+
+    HashSet<std::string> chained;
+    HashSet<std::string, RobinHood> robinHood;
+    std::string buffer = "the quick brown fox";
+    std::string_view quick = std::string_view{buffer}.substr(4, 5);
+
+    chained.insert(quick);
+    robinHood.insert(quick);
+    chained.insert("fox");
+    robinHood.insert("fox");
+    affirm_expected(chained.size(), 2);
+    affirm_expected(robinHood.size(), 2);
+
+    // all three key types find the same elements
+    affirm(chained.exists(std::string{"quick"}));
+    affirm(chained.exists(std::string_view{"fox"}));
+    affirm(robinHood.exists("quick"));
+    affirm(robinHood.exists(std::string_view{buffer}.substr(16)));
+    affirm(!chained.exists(std::string_view{buffer}.substr(0, 3)));
+    affirm(!robinHood.exists("brown"));
+
+    // a key that is already there isn't added again
+    chained.insert(std::string_view{"fox"});
+    affirm_expected(chained.size(), 2);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the Hash and KeyEqual policy parameters
+ */
+bool hashPolicyTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"12 hash and equality policies"};
+
+    HashSet<std::string, Chaining, NoCaseHash, NoCaseEqual> chained;
+    HashSet<std::string, RobinHood, NoCaseHash, NoCaseEqual> robinHood;
+    chained.insert(std::string{"Llama"});
+    robinHood.insert(std::string{"Llama"});
+    chained.insert(std::string{"LLAMA"});
+    affirm_expected(chained.size(), 1);
+    affirm(chained.exists(std::string{"llama"}));
+    affirm(robinHood.exists(std::string{"lLaMa"}));
+    affirm(!robinHood.exists(std::string{"alpaca"}));
+
+    // a gallery function plugged in at compile time
+    HashSet<std::string, Chaining, GalleryHash<gallery::djb2Hash>> djb2(1);
+    for (int i = 0; i < 100; ++i) {
+        djb2.insert(std::to_string(i));
+    }
+    affirm_expected(djb2.size(), 100);
+    affirm(djb2.exists("42"));
+    affirm(djb2.exists(std::string_view{"99"}));
+    affirm(!djb2.exists("100"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the word-at-a-time hash from the gallery: the
+ *         SIMD and portable long-key loops must agree, and nearby keys
+ *         must hash differently
+ */
+bool wordHashTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"13 word-at-a-time hash (SIMD and scalar agree)"};
+
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += char('a' + (i * 7919) % 26);
+    }
+    uint64_t scalar[4] = {1, 2, 3, 4};
+    uint64_t simd[4] = {1, 2, 3, 4};
+    gallery::wordhash::accumulateScalar(text.data(), 31, scalar);
+    gallery::wordhash::accumulate(text.data(), 31, simd);
+    bool same = true;
+    for (size_t lane = 0; lane < 4; ++lane) {
+        same = same && scalar[lane] == simd[lane];
+    }
+    affirm(same);
+
+    // every prefix length (short, tail-only, and long keys) hashes
+    // differently from its neighbours
+    bool distinct = true;
+    for (size_t len = 1; len < 200; ++len) {
+        std::string_view shorter{text.data(), len - 1};
+        std::string_view longer{text.data(), len};
+        distinct = distinct
+                   && gallery::wordAtATimeHash(shorter)
+                          != gallery::wordAtATimeHash(longer);
+    }
+    affirm(distinct);
+    affirm(gallery::wordAtATimeHash("abc") != gallery::wordAtATimeHash("acb"));
+    affirm(gallery::wordAtATimeHash(std::string_view{"a\0", 2})
+           != gallery::wordAtATimeHash(std::string_view{"a", 1}));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the Swiss-table layout, including growing it
+ *         while it is full of near-identical hashes
+ */
+bool swissTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"14 swiss table layout (insert, exists, rehash)"};
+
+    // slots come in groups of 16
+    HashSet<std::string, Swiss> words(20);
+    affirm_expected(words.buckets(), 32);
+
+    for (int i = 0; i < 2000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    words.insert(std::string{"7"});
+    affirm_expected(words.size(), 2000);
+    affirm(words.reallocations() > 0);
+
+    bool allFound = true;
+    for (int i = 0; i < 2000; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    affirm(allFound);
+    affirm(!words.exists("2000"));
+    affirm(!words.exists(std::string_view{"-1"}));
+
+    // the test's int hash is terrible (lots of equal hashes), so many tags
+    // match and probes run long, but everything must still be found
+    HashSet<CopyCounter, Swiss> clumped;
+    for (int i = 0; i < 300; ++i) {
+        clumped.emplace(i);
+    }
+    bool clumpedFound = true;
+    for (int i = 0; i < 300; ++i) {
+        clumpedFound = clumpedFound && clumped.exists(CopyCounter{i});
+    }
+    affirm(clumpedFound);
+    affirm(!clumped.exists(CopyCounter{300}));
+
+    // growing incrementally leaves the old table entirely full for a while,
+    // and searches of it must still stop
+    HashSet<std::string, Swiss> draining(16);
+    draining.incrementalRehash(true);
+    for (int i = 0; i < 17; ++i) {
+        draining.insert(std::to_string(i));
+    }
+    affirm(draining.rehashing());
+    affirm(!draining.exists("17"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief Test the Bloom filter on its own, and as HashSet's prefilter
+ *
+ */
+bool bloomFilterTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"15 Bloom filter (no false negatives, rate, rebuild)"};
+
+    BloomFilter filter{10000, 0.01};
+    for (size_t i = 0; i < 10000; ++i) {
+        filter.add(gallery::wordAtATimeHash(std::to_string(i)));
+    }
+    bool noFalseNegatives = true;
+    for (size_t i = 0; i < 10000; ++i) {
+        noFalseNegatives = noFalseNegatives
+            && filter.mayContain(gallery::wordAtATimeHash(std::to_string(i)));
+    }
+    affirm(noFalseNegatives);
+    // at the rate it was sized for, well under 2% of misses should get past
+    size_t falsePositives = 0;
+    for (size_t i = 10000; i < 110000; ++i) {
+        if (filter.mayContain(gallery::wordAtATimeHash(std::to_string(i)))) {
+            ++falsePositives;
+        }
+    }
+    affirm(falsePositives < 2000);
+
+    // turned on while empty, so the filter must be rebuilt as the set grows
+    HashSet<std::string, Swiss> words;
+    words.useBloomFilter(0.01);
+    affirm_expected(words.bloomFalsePositiveRate(), 0.01);
+    words.incrementalRehash(true);
+    for (int i = 0; i < 5000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    // inserts search first, so most of them were answered by the filter
+    size_t rejected = words.bloomRejections();
+    affirm(rejected > 4500);
+    bool allFound = true;
+    for (int i = 0; i < 5000; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    affirm(allFound);
+    affirm_expected(words.bloomRejections(), rejected);
+    for (int i = 5000; i < 6000; ++i) {
+        words.exists(std::to_string(i));
+    }
+    affirm(words.bloomRejections() - rejected > 900);
+
+    // turned on after the inserts, the filter is built from the table
+    HashSet<std::string> chained;
+    chained.insert(std::string{"bloom"});
+    chained.useBloomFilter(0.001);
+    affirm(chained.exists("bloom"));
+    affirm(!chained.exists("blossom"));
+    chained.useBloomFilter(0.0);
+    affirm_expected(chained.bloomFalsePositiveRate(), 0.0);
+    affirm(chained.exists("bloom"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Overwrites four bytes of a saved image, at a position counted from the
+/// start of the file or (if fromEntries) from the start of its entries,
+/// and returns whether mapping the image is then refused
+bool refusesDamage(const std::string& filename, uint64_t position,
+                   uint32_t value, bool fromEntries) {
+    std::fstream file{filename,
+                      std::ios::binary | std::ios::in | std::ios::out};
+    if (fromEntries) {
+        // the header's entriesOffset comes after 8 bytes of magic, two
+        // 4-byte and three 8-byte fields
+        uint64_t entriesOffset;
+        file.seekg(40);
+        file.read(reinterpret_cast<char*>(&entriesOffset),
+                  sizeof(entriesOffset));
+        position += entriesOffset;
+    }
+    file.seekp(position);
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    file.close();
+    try {
+        DictImage<> damaged{filename};
+    } catch (std::runtime_error& e) {
+        return true;
+    }
+    return false;
+}
+
+/** \brief Test saving a set as a dictionary image and mapping it back
+ *
+ */
+bool dictImageTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"16 dictionary image (save, map, exists, checks)"};
+
+    constexpr const char* IMAGE_FILE = "hashset-test.image";
+    HashSet<std::string, Swiss> words;
+    for (int i = 0; i < 1000; ++i) {
+        words.insert(std::to_string(i * 7));
+    }
+    words.insert(std::string{""});
+    DictImage<>::save(words, IMAGE_FILE);
+
+    {
+        DictImage<> image{IMAGE_FILE};
+        affirm_expected(image.size(), 1001);
+        affirm_expected(image.buckets(), 1024);
+        bool allFound = true;
+        bool noneExtra = true;
+        for (int i = 0; i < 1000; ++i) {
+            allFound = allFound && image.exists(std::to_string(i * 7));
+            noneExtra = noneExtra && !image.exists(std::to_string(i * 7 + 1));
+        }
+        affirm(allFound);
+        affirm(noneExtra);
+        affirm(image.exists(""));
+        affirm(!image.exists(std::string_view{"710", 2}));
+    }
+
+    // an image is refused if opened with a different hash function
+    bool refused = false;
+    try {
+        DictImage<GalleryHash<gallery::djb2Hash>> wrongHash{IMAGE_FILE};
+    } catch (std::runtime_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+
+    // ... or if it isn't an image at all
+    {
+        std::ofstream out{IMAGE_FILE};
+        out << "not an image, just some words that are long enough to fill "
+               "a whole header\n";
+    }
+    refused = false;
+    try {
+        DictImage<> notImage{IMAGE_FILE};
+    } catch (std::runtime_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+
+    // ... or if its bucket offsets or entries point outside the file (the
+    // 64-byte header is followed by the bucket offsets, and an entry's
+    // length is the last four of its 16 bytes)
+    DictImage<>::save(words, IMAGE_FILE);
+    affirm(refusesDamage(IMAGE_FILE, 64 + 4, 5000, false));
+    DictImage<>::save(words, IMAGE_FILE);
+    affirm(refusesDamage(IMAGE_FILE, 64 + 4 * 500, 0, false));
+    DictImage<>::save(words, IMAGE_FILE);
+    affirm(refusesDamage(IMAGE_FILE, 12, 0xFFFFFFF0, true));
+    DictImage<>::save(words, IMAGE_FILE);
+    affirm(refusesDamage(IMAGE_FILE, 16 * 1000 + 8, 0xFFFFFFF0, true));
+
+    // ... or if its header claims more words, starting so near the end of
+    // memory that adding up their sizes wraps around to the real strings
+    DictImage<>::save(words, IMAGE_FILE);
+    {
+        std::fstream file{IMAGE_FILE,
+                          std::ios::binary | std::ios::in | std::ios::out};
+        // numWords, entriesOffset and stringsOffset are at 24, 40 and 48
+        uint64_t stringsOffset;
+        file.seekg(48);
+        file.read(reinterpret_cast<char*>(&stringsOffset),
+                  sizeof(stringsOffset));
+        uint64_t numWords = stringsOffset / 16 + 1;
+        uint64_t entriesOffset = stringsOffset - numWords * 16;
+        uint32_t lastStart = uint32_t(numWords);
+        file.seekp(24);
+        file.write(reinterpret_cast<const char*>(&numWords),
+                   sizeof(numWords));
+        file.seekp(40);
+        file.write(reinterpret_cast<const char*>(&entriesOffset),
+                   sizeof(entriesOffset));
+        // and the last bucket offset agrees with the new word count
+        file.seekp(64 + 4 * 1024);
+        file.write(reinterpret_cast<const char*>(&lastStart),
+                   sizeof(lastStart));
+    }
+    refused = false;
+    try {
+        DictImage<> wrapped{IMAGE_FILE};
+    } catch (std::runtime_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+    std::remove(IMAGE_FILE);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the arena layout: strings stored as offsets
+ *         into one shared byte array
+ */
+bool arenaTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"17 arena layout (insert, exists, rehash, print)"};
+
+    HashSet<std::string, Arena> words(4);
+    words.insert(std::string{"zebra"});
+    words.insert("yak");
+    words.emplace(3, 'x');
+    words.insert(std::string_view{"yak"});
+    affirm_expected(words.size(), 3);
+    affirm(words.exists("xxx"));
+    affirm(words.exists(std::string{"zebra"}));
+    affirm(!words.exists("zebr"));
+    affirm(!words.exists(""));
+
+    // grow it, incrementally too, so strings are copied between arenas
+    words.incrementalRehash(true);
+    for (int i = 0; i < 3000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    words.insert(std::string{""});
+    affirm_expected(words.size(), 3004);
+    affirm(words.reallocations() > 0);
+    bool allFound = true;
+    for (int i = 0; i < 3000; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    affirm(allFound);
+    affirm(words.exists(""));
+    affirm(!words.exists("3000"));
+
+    size_t totalLength = 0;
+    words.forEach([&](std::string_view word) { totalLength += word.size(); });
+    // 5 + 3 + 3 + (10 + 90 * 2 + 900 * 3 + 2000 * 4)
+    affirm_expected(totalLength, 10901);
+
+    HashSet<std::string, Arena> small(2);
+    small.insert("hi");
+    std::stringstream ss;
+    ss << small;
+    affirm(ss.str() == "[0]hi\n[1]\n" || ss.str() == "[0]\n[1]hi\n");
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief Test that existsBatch gives the same answers as exists
+ *
+ */
+bool existsBatchTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"18 existsBatch (matches exists, keys, bloom, image)"};
+
+    HashSet<std::string, RobinHood> words;
+    words.incrementalRehash(true);
+    for (int i = 0; i < 1000; i += 2) {
+        words.insert(std::to_string(i));
+    }
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(std::to_string(i));
+    }
+    // an odd count, so the last window is only partly full
+    keys.push_back("x");
+
+    std::vector<char> found(keys.size());
+    auto end = words.existsBatch(keys.begin(), keys.end(), found.begin());
+    affirm(end == found.end());
+    bool allMatch = true;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        allMatch = allMatch && bool(found[i]) == words.exists(keys[i]);
+    }
+    affirm(allMatch);
+    affirm_expected(std::count(found.begin(), found.end(), true), 500);
+
+    // transparent keys, with the Bloom filter prefetched instead
+    words.useBloomFilter(0.01);
+    std::vector<std::string_view> views(keys.begin(), keys.end());
+    std::vector<bool> viewFound;
+    words.existsBatch(views.begin(), views.end(),
+                      std::back_inserter(viewFound));
+    affirm(std::equal(found.begin(), found.end(), viewFound.begin()));
+
+    // and a dictionary image
+    constexpr const char* IMAGE_FILE = "hashset-test.image";
+    DictImage<>::save(words, IMAGE_FILE);
+    {
+        DictImage<> image{IMAGE_FILE};
+        std::vector<char> imageFound(keys.size());
+        image.existsBatch(keys.begin(), keys.end(), imageFound.begin());
+        affirm(imageFound == found);
+    }
+    std::remove(IMAGE_FILE);
+
+    // nothing to look up
+    affirm(words.existsBatch(keys.end(), keys.end(), found.begin())
+           == found.begin());
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief Test ConcurrentHashSet with several threads inserting and
+ *         searching at once
+ */
+bool concurrentTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"19 concurrent hash set (threads, shards, statistics)"};
+
+    ConcurrentHashSet<std::string, Swiss> words(8);
+    affirm_expected(words.shards(), 8);
+    words.incrementalRehash(true);
+
+    constexpr int NUM_WRITERS = 4;
+    constexpr int PER_WRITER = 5000;
+    std::atomic<bool> readersWrong{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_WRITERS; ++t) {
+        // each writer inserts its own numbers (and some of the others')
+        threads.emplace_back([&words, t] {
+            for (int i = 0; i < PER_WRITER; ++i) {
+                words.insert(std::to_string(i * NUM_WRITERS + t));
+                words.insert(std::to_string(i * NUM_WRITERS));
+            }
+        });
+        // each reader checks for words that are never inserted
+        threads.emplace_back([&words, &readersWrong, t] {
+            for (int i = 0; i < PER_WRITER; ++i) {
+                if (words.exists(std::string_view{"x" + std::to_string(i)})) {
+                    readersWrong = true;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    affirm(!readersWrong);
+    affirm_expected(words.size(), NUM_WRITERS * PER_WRITER);
+
+    bool allFound = true;
+    for (int i = 0; i < NUM_WRITERS * PER_WRITER; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    affirm(allFound);
+    affirm(words.reallocations() >= words.shards());
+    affirm(words.maximal() > 0);
+    affirm(words.loadFactor() <= Swiss::Table<std::string>::MAX_LOAD_LIMIT);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+bool wordFileTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"20 word file (mmap, whitespace, long words)"};
+
+    constexpr const char* WORD_FILE = "hashset-test.words";
+    // words longer than 16 bytes and runs of spaces cross the scanner's
+    // 16-byte blocks, and the last word has no newline after it
+    std::string longWord(40, 'x');
+    std::vector<std::string> expected{"alpha", "beta",   "gamma",  longWord,
+                                      "delta", "eps\x01", "zeta"};
+    {
+        std::ofstream out{WORD_FILE};
+        out << "  alpha beta\tgamma\n\n" << longWord << std::string(37, ' ')
+            << "delta\r\neps\x01\v\f zeta";
+    }
+    {
+        WordFile file{WORD_FILE};
+        std::vector<std::string> words(file.begin(), file.end());
+        affirm(words == expected);
+        affirm(file.contents().substr(0, 7) == "  alpha");
+    }
+
+    // a file of nothing but whitespace (or nothing at all) has no words
+    {
+        std::ofstream out{WORD_FILE};
+        out << std::string(50, ' ') << "\n";
+    }
+    {
+        WordFile file{WORD_FILE};
+        affirm(file.begin() == file.end());
+    }
+    {
+        std::ofstream out{WORD_FILE};
+    }
+    {
+        WordFile file{WORD_FILE};
+        affirm(file.begin() == file.end());
+        affirm(file.contents().empty());
+    }
+    std::remove(WORD_FILE);
+
+    bool refused = false;
+    try {
+        WordFile missing{WORD_FILE};
+    } catch (std::system_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+bool wordStreamTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"21 word stream (chunks, straddling words, bounds)"};
+
+    constexpr const char* WORD_FILE = "hashset-test.words";
+    std::string longWord(40, 'y');
+    {
+        std::ofstream out{WORD_FILE};
+        out << "  alpha beta\tgamma\n\n" << longWord << std::string(37, ' ')
+            << "delta\r\nepsilon zeta";
+    }
+    std::vector<std::string> expected;
+    {
+        WordFile file{WORD_FILE};
+        expected.assign(file.begin(), file.end());
+    }
+
+    // however small the chunks, the words come out the same (including
+    // words longer than a chunk, and the last one with no newline)
+    bool allSame = true;
+    bool chunksBounded = true;
+    for (size_t chunkSize : {1, 3, 7, 16, 64, 4096}) {
+        WordStream stream{WORD_FILE, chunkSize};
+        affirm_expected(stream.chunkSize(), chunkSize);
+        std::vector<std::string> words;
+        std::vector<std::string_view> chunk;
+        while (stream.nextChunk(chunk)) {
+            chunksBounded = chunksBounded && chunk.size() <= chunkSize;
+            words.insert(words.end(), chunk.begin(), chunk.end());
+        }
+        allSame = allSame && words == expected;
+        affirm(!stream.nextChunk(chunk));
+        affirm(chunk.empty());
+    }
+    affirm(allSame);
+    affirm(chunksBounded);
+
+    // stopping early leaves the reader to finish quietly
+    {
+        WordStream stream{WORD_FILE, 2};
+        std::vector<std::string_view> chunk;
+        affirm(stream.nextChunk(chunk));
+    }
+    std::remove(WORD_FILE);
+
+    bool refused = false;
+    try {
+        WordStream missing{WORD_FILE};
+    } catch (std::system_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+bool frozenHashSetTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"22 frozen hash set (perfect hash, keys, batch, dups)"};
+
+    HashSet<std::string, Arena> words;
+    for (int i = 0; i < 5000; i += 2) {
+        words.insert(std::to_string(i));
+    }
+    FrozenHashSet<std::string> frozen{words};
+    affirm_expected(frozen.size(), 2500);
+    affirm(frozen.bitsPerKey() > 0.0);
+    affirm(frozen.bitsPerKey() < 16.0);
+    bool allMatch = true;
+    for (int i = 0; i < 5000; ++i) {
+        std::string key = std::to_string(i);
+        allMatch = allMatch && frozen.exists(key) == (i % 2 == 0)
+                   && frozen.exists(std::string_view{key}) == (i % 2 == 0);
+    }
+    affirm(allMatch);
+    affirm(!frozen.exists(""));
+
+    // batches agree with single lookups
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1001; ++i) {
+        keys.push_back(std::to_string(i));
+    }
+    std::vector<char> found(keys.size());
+    affirm(frozen.existsBatch(keys.begin(), keys.end(), found.begin())
+           == found.end());
+    affirm_expected(std::count(found.begin(), found.end(), true), 501);
+
+    // duplicates in a range are dropped, and an empty set finds nothing
+    std::vector<std::string> repeats{"b", "a", "b", "c", "a"};
+    FrozenHashSet<std::string> fromRange{repeats.begin(), repeats.end()};
+    affirm_expected(fromRange.size(), 3);
+    affirm(fromRange.exists("a") && fromRange.exists("b")
+           && fromRange.exists("c") && !fromRange.exists("d"));
+    FrozenHashSet<std::string> empty{keys.end(), keys.end()};
+    affirm_expected(empty.size(), 0);
+    affirm(!empty.exists("a"));
+    affirm(empty.existsBatch(keys.begin(), keys.begin() + 3, found.begin())
+           == found.begin() + 3);
+    affirm(!found[0] && !found[1] && !found[2]);
+
+    // different elements with the same hash can't be perfectly hashed
+    std::vector<std::string> clash{"Word", "word"};
+    bool refused = false;
+    try {
+        FrozenHashSet<std::string, NoCaseHash> clashing{clash.begin(),
+                                                        clash.end()};
+    } catch (std::invalid_argument& e) {
+        refused = true;
+    }
+    affirm(refused);
+    FrozenHashSet<std::string, NoCaseHash, NoCaseEqual> noCase{clash.begin(),
+                                                               clash.end()};
+    affirm_expected(noCase.size(), 1);
+    affirm(noCase.exists("WORD"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Inserts keys that all collide into a set that reseeds after a few
+/// steps, and checks that it got away from the collisions: no search is
+/// longer than the given limit, far below the 1000 of one chain
+template <typename Layout>
+bool reseedsAwayFromCollisions(size_t limit) {
+    constexpr size_t LIMIT = 16;
+    HashSet<std::string, Layout, CollideUntilReseeded> words;
+    words.reseedAfter(LIMIT);
+    for (int i = 0; i < 1000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    bool allFound = true;
+    for (int i = 0; i < 1000; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    return allFound && words.size() == 1000 && !words.exists("1000")
+           && words.reseeds() >= 1 && words.maximal() < limit;
+}
+
+bool seededHashTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"23 keyed hashing and reseeding"};
+
+    // SipHash-1-3 under the reference test key (bytes 0 to 15)
+    constexpr uint64_t KEY0 = 0x0706050403020100ULL;
+    constexpr uint64_t KEY1 = 0x0f0e0d0c0b0a0908ULL;
+    affirm_expected(sipHash13("", KEY0, KEY1), 12370263754033579228ULL);
+    affirm_expected(sipHash13("hello", KEY0, KEY1), 13168010244364928439ULL);
+    affirm_expected(sipHash13("abcdefgh", KEY0, KEY1), 1358046995967239712ULL);
+
+    // the same seed gives the same hash, whatever the string type, and
+    // different seeds (including random ones) give different hashes
+    SipHash seven{7};
+    affirm(seven("llama") == seven(std::string{"llama"}));
+    affirm(seven("llama") == SipHash{7}(std::string_view{"llama"}));
+    affirm(seven("llama") != SipHash{8}("llama"));
+    affirm(SipHash{}("llama") != SipHash{}("llama"));
+
+    // never reseeding leaves one long chain
+    HashSet<std::string, Chaining, CollideUntilReseeded> stuck;
+    for (int i = 0; i < 300; ++i) {
+        stuck.insert(std::to_string(i));
+    }
+    affirm_expected(stuck.maximal(), 300);
+    affirm_expected(stuck.reseeds(), 0);
+
+    // with a limit, every layout reseeds and the chains stay short
+    affirm(reseedsAwayFromCollisions<Chaining>(16));
+    affirm(reseedsAwayFromCollisions<RobinHood>(16));
+    affirm(reseedsAwayFromCollisions<Swiss>(16));
+    // (linear probing can pass the limit by a little between reseeds)
+    affirm(reseedsAwayFromCollisions<Arena>(32));
+
+    // reseeding in the middle of an incremental rehash, with a Bloom filter
+    HashSet<std::string, Chaining, SipHash> words;
+    words.incrementalRehash(true);
+    words.useBloomFilter(0.01);
+    int count = 0;
+    while (count < 100 || !words.rehashing()) {
+        words.insert(std::to_string(count++));
+    }
+    size_t buckets = words.buckets();
+    words.reseed();
+    affirm(!words.rehashing());
+    affirm_expected(words.buckets(), buckets);
+    affirm_expected(words.size(), count);
+    affirm_expected(words.reseeds(), 1);
+    bool allFound = true;
+    for (int i = 0; i < count; ++i) {
+        allFound = allFound && words.exists(std::to_string(i));
+    }
+    affirm(allFound);
+    affirm(!words.exists("llama"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/** \brief This test checks the cuckoo layout: searches read at most two
+ *         buckets, the table grows by itself when displacing fails, a
+ *         few elements with equal hashes still fit (in the stash), and
+ *         too many of them make inserting throw
+ */
+bool cuckooTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"24 cuckoo layout (two buckets, displacement, stash)"};
+
+    // slots come in buckets of four, and there are at least two buckets
+    HashSet<std::string, Cuckoo> words(20);
+    affirm_expected(words.buckets(), 32);
+    HashSet<std::string, Cuckoo> tiny(1);
+    affirm_expected(tiny.buckets(), 8);
+
+    for (int i = 0; i < 2000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    words.insert(std::string{"7"});
+    affirm_expected(words.size(), 2000);
+    affirm(words.reallocations() > 0);
+
+    bool allFound = true;
+    for (int i = 0; i < 4000; ++i) {
+        allFound = allFound && words.exists(std::to_string(i)) == (i < 2000);
+    }
+    affirm(allFound);
+    affirm(!words.exists(std::string_view{"-1"}));
+    // an insert counts one step more than its search
+    affirm(words.maximal() <= 3);
+
+    // filling the table right up makes displacement fail, so it grows
+    CuckooTable<int> table{8};
+    size_t steps;
+    for (int i = 0; i < 9; ++i) {
+        table.emplaceNew(gallery::wordAtATimeHash(std::to_string(i)), i);
+    }
+    affirm(table.buckets() > 8);
+    bool tableFound = true;
+    for (int i = 0; i < 9; ++i) {
+        tableFound =
+            tableFound
+            && table.contains(gallery::wordAtATimeHash(std::to_string(i)), i,
+                              std::equal_to<>{}, steps);
+    }
+    affirm(tableFound);
+
+    // the test's int hash gives lots of elements equal hashes, more than
+    // two buckets can hold, so some are stashed, even while rehashing
+    HashSet<CopyCounter, Cuckoo> clumped;
+    clumped.incrementalRehash(true);
+    for (int i = 0; i < 150; ++i) {
+        clumped.emplace(i);
+    }
+    affirm_expected(clumped.size(), 150);
+    bool clumpedFound = true;
+    for (int i = 0; i < 150; ++i) {
+        clumpedFound = clumpedFound && clumped.exists(CopyCounter{i});
+    }
+    affirm(clumpedFound);
+    affirm(!clumped.exists(CopyCounter{150}));
+    size_t visited = 0;
+    clumped.forEach([&visited](const CopyCounter&) { ++visited; });
+    affirm_expected(visited, 150);
+    // the stash is small, so even these searches stay short
+    affirm(clumped.maximal() > 3);
+    affirm(clumped.maximal() <= 3 + CuckooTable<CopyCounter>::MAX_STASH);
+
+    // the table grows by itself trying to split up equal hashes, and each
+    // of those grows is a reallocation too
+    HashSet<int, Cuckoo> grown;
+    for (int i = 0; i < 150; ++i) {
+        grown.insert(i);
+    }
+    affirm_expected(grown.buckets(), size_t(16) << grown.reallocations());
+
+    // once the stash is full too, inserting throws and leaves the set
+    // as it was
+    bool refused = false;
+    int inserted = 0;
+    try {
+        for (; inserted < 300; ++inserted) {
+            grown.insert(inserted);
+        }
+    } catch (std::length_error& e) {
+        refused = true;
+    }
+    affirm(refused);
+    affirm_expected(grown.size(), size_t(inserted));
+    bool grownFound = true;
+    for (int i = 0; i < inserted; ++i) {
+        grownFound = grownFound && grown.exists(i);
+    }
+    affirm(grownFound);
+    affirm(!grown.exists(inserted));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Reserves room in a set, fills it without it rehashing, and shrinks it
+/// back down once it is too big
+template <typename Layout>
+bool reservesAndShrinks() {
+    HashSet<std::string, Layout> words;
+    words.reserve(5000);
+    size_t reallocations = words.reallocations();
+    size_t buckets = words.buckets();
+    bool ok = reallocations == 1
+              && buckets * words.getMaxLoad() >= 5000;
+    for (int i = 0; i < 5000; ++i) {
+        words.insert(std::to_string(i));
+    }
+    ok = ok && words.reallocations() == reallocations
+         && words.buckets() == buckets && words.worstInsert() == 0;
+
+    // asking for less than there is room for changes nothing
+    words.reserve(10);
+    ok = ok && words.buckets() == buckets;
+
+    HashSet<std::string, Layout> roomy;
+    roomy.reserve(100000);
+    for (int i = 0; i < 100; ++i) {
+        roomy.insert(std::to_string(i));
+    }
+    size_t big = roomy.buckets();
+    roomy.shrinkToFit();
+    ok = ok && roomy.buckets() < big && roomy.size() == 100
+         && roomy.loadFactor() <= roomy.getMaxLoad();
+    for (int i = 0; i < 100; ++i) {
+        ok = ok && roomy.exists(std::to_string(i));
+    }
+    return ok;
+}
+
+bool reserveTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"25 reserve and shrinkToFit"};
+
+    affirm(reservesAndShrinks<Chaining>());
+    affirm(reservesAndShrinks<RobinHood>());
+    affirm(reservesAndShrinks<Swiss>());
+    affirm(reservesAndShrinks<Arena>());
+    affirm(reservesAndShrinks<Cuckoo>());
+
+    // chained tables get exactly the buckets asked for
+    HashSet<int> numbers(10, 2.0);
+    numbers.reserve(101);
+    affirm_expected(numbers.buckets(), 51);
+
+    // an empty set shrinks to a single bucket, and still works
+    HashSet<int> empty;
+    empty.shrinkToFit();
+    affirm_expected(empty.buckets(), 1);
+    empty.insert(3);
+    affirm(empty.exists(3));
+
+    // reserving in the middle of an incremental rehash finishes it, and a
+    // Bloom filter grows with the table
+    HashSet<std::string, Chaining> growing(10, 1.0);
+    growing.incrementalRehash(true);
+    growing.useBloomFilter(0.01);
+    int count = 0;
+    while (!growing.rehashing()) {
+        growing.insert(std::to_string(count++));
+    }
+    growing.reserve(1000);
+    affirm(!growing.rehashing());
+    affirm_expected(growing.buckets(), 1000);
+    affirm(growing.bloomFalsePositiveRate() > 0.0);
+    bool allFound = true;
+    for (int i = 0; i < count; ++i) {
+        allFound = allFound && growing.exists(std::to_string(i));
+    }
+    affirm(allFound);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Fills a set, erases every third key (twice), puts some back, and checks
+/// that exactly the right keys are left
+template <typename Set, typename MakeKey>
+bool erasesExactly(Set& set, MakeKey key, int count) {
+    for (int i = 0; i < count; ++i) {
+        set.insert(key(i));
+    }
+    bool ok = true;
+    for (int i = 0; i < count; i += 3) {
+        ok = ok && set.erase(key(i)) && !set.erase(key(i));
+    }
+    ok = ok && !set.erase(key(count));
+    for (int i = 0; i < count; i += 6) {
+        set.insert(key(i));
+    }
+    for (int i = 0; i < count; ++i) {
+        bool erased = i % 3 == 0 && i % 6 != 0;
+        ok = ok && set.exists(key(i)) == !erased;
+    }
+    int left = count - (count + 2) / 3 + (count + 5) / 6;
+    return ok && set.size() == size_t(left);
+}
+
+/// Erases keys from a set of each layout, including keys whose hashes are
+/// all alike, and checks that emptying a big set shrinks it
+template <typename Layout>
+bool erasesAndShrinks() {
+    auto word = [](int i) { return std::to_string(i); };
+    HashSet<std::string, Layout> words;
+    bool ok = erasesExactly(words, word, 2000);
+
+    HashSet<std::string, Layout> big;
+    for (int i = 0; i < 10000; ++i) {
+        big.insert(word(i));
+    }
+    size_t bigBuckets = big.buckets();
+    for (int i = 0; i < 9990; ++i) {
+        ok = ok && big.erase(std::string_view{word(i)});
+    }
+    ok = ok && big.size() == 10 && big.buckets() * 8 <= bigBuckets
+         && big.loadFactor() >= big.getMinLoad();
+    for (int i = 9990; i < 10000; ++i) {
+        ok = ok && big.exists(word(i));
+    }
+
+    // with no minimum, erasing never shrinks the table
+    HashSet<std::string, Layout> kept;
+    kept.minLoadFactor(0.0);
+    for (int i = 0; i < 1000; ++i) {
+        kept.insert(word(i));
+    }
+    size_t keptBuckets = kept.buckets();
+    for (int i = 0; i < 1000; ++i) {
+        kept.erase(word(i));
+    }
+    return ok && kept.size() == 0 && kept.buckets() == keptBuckets;
+}
+
+/// Keeps a set at a steady size while erasing old keys and inserting new
+/// ones, which leaves vacated slots behind in the open-addressed layouts,
+/// and checks that searches stay short
+template <typename Layout>
+bool churnStaysShort(size_t limit) {
+    constexpr int SIZE = 20000;
+    HashSet<std::string, Layout> words;
+    int next = 0;
+    for (; next < SIZE; ++next) {
+        words.insert(std::to_string(next));
+    }
+    for (int round = 0; round < 40; ++round) {
+        for (int stop = next + SIZE; next < stop; ++next) {
+            words.erase(std::to_string(next - SIZE));
+            words.insert(std::to_string(next));
+        }
+    }
+    bool missed = true;
+    for (int i = 0; i < 1000; ++i) {
+        missed = missed && !words.exists(std::to_string(i));
+    }
+    return missed && words.size() == SIZE && words.maximal() < limit;
+}
+
+bool eraseTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"26 erase (every layout, shrinking, rehashing)"};
+
+    affirm(erasesAndShrinks<Chaining>());
+    affirm(erasesAndShrinks<RobinHood>());
+    affirm(erasesAndShrinks<Swiss>());
+    affirm(erasesAndShrinks<Arena>());
+    affirm(erasesAndShrinks<Cuckoo>());
+
+    // without clearing out vacated slots, these reach a whole-table scan
+    affirm(churnStaysShort<Swiss>(100));
+    affirm(churnStaysShort<Arena>(1000));
+
+    // the test's int hash gives many keys equal hashes, so erasing has to
+    // keep long probe sequences (and the cuckoo stash) intact
+    auto counter = [](int i) { return CopyCounter{i}; };
+    HashSet<CopyCounter, Chaining> chained;
+    HashSet<CopyCounter, RobinHood> robinHood;
+    HashSet<CopyCounter, Swiss> swiss;
+    HashSet<CopyCounter, Cuckoo> cuckoo;
+    affirm(erasesExactly(chained, counter, 300));
+    affirm(erasesExactly(robinHood, counter, 300));
+    affirm(erasesExactly(swiss, counter, 300));
+    affirm(erasesExactly(cuckoo, counter, 150));
+
+    // erasing while rehashing finds keys in either table, and the Bloom
+    // filter's stale bits don't bring erased keys back
+    HashSet<std::string, Swiss> draining(16);
+    draining.incrementalRehash(true);
+    draining.useBloomFilter(0.01);
+    int count = 0;
+    while (count < 100 || !draining.rehashing()) {
+        draining.insert(std::to_string(count++));
+    }
+    bool allErased = true;
+    for (int i = 0; i < count; i += 2) {
+        allErased = allErased && draining.erase(std::to_string(i));
+    }
+    affirm(allErased);
+    bool rightOnesLeft = true;
+    for (int i = 0; i < count; ++i) {
+        rightOnesLeft =
+            rightOnesLeft && draining.exists(std::to_string(i)) == (i % 2);
+    }
+    affirm(rightOnesLeft);
+
+    // the concurrent set erases from the right shard
+    ConcurrentHashSet<std::string> shared(4);
+    shared.insert(std::string{"llama"});
+    shared.insert(std::string{"alpaca"});
+    affirm(shared.erase(std::string_view{"llama"}));
+    affirm(!shared.erase(std::string{"llama"}));
+    affirm(!shared.exists("llama"));
+    affirm(shared.exists("alpaca"));
+    affirm_expected(shared.size(), 1);
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Copies a set of each layout, changes the original and the copy in
+/// different ways, and checks that each sees only its own changes
+template <typename Layout>
+bool copiesAreSnapshots() {
+    HashSet<std::string, Layout> original;
+    for (int i = 0; i < 500; ++i) {
+        original.insert(std::to_string(i));
+    }
+    HashSet<std::string, Layout> copy{original};
+    bool ok = original.shared() && copy.shared() && copy.size() == 500;
+
+    // lookups and failed erases don't stop them sharing
+    ok = ok && copy.exists("499") && !copy.erase(std::string{"500"})
+         && copy.shared();
+
+    original.insert(std::string{"llama"});
+    copy.erase(std::string{"0"});
+    ok = ok && !original.shared() && !copy.shared();
+    ok = ok && original.exists("llama") && original.exists("0")
+         && original.size() == 501;
+    ok = ok && !copy.exists("llama") && !copy.exists("0")
+         && copy.size() == 499;
+
+    // assignment shares too, and growing one doesn't touch the other
+    HashSet<std::string, Layout> assigned;
+    assigned = original;
+    for (int i = 500; i < 2000; ++i) {
+        original.insert(std::to_string(i));
+    }
+    bool allThere = true;
+    for (int i = 0; i < 500; ++i) {
+        allThere = allThere && assigned.exists(std::to_string(i));
+    }
+    return ok && allThere && assigned.size() == 501
+           && !assigned.exists("1999") && original.size() == 2001;
+}
+
+bool snapshotTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"27 copy-on-write snapshots"};
+
+    affirm(copiesAreSnapshots<Chaining>());
+    affirm(copiesAreSnapshots<RobinHood>());
+    affirm(copiesAreSnapshots<Swiss>());
+    affirm(copiesAreSnapshots<Arena>());
+    affirm(copiesAreSnapshots<Cuckoo>());
+
+    // a copy made in the middle of an incremental rehash, with a Bloom
+    // filter, keeps working when either side finishes the move
+    HashSet<std::string, Chaining> moving(16);
+    moving.incrementalRehash(true);
+    moving.useBloomFilter(0.01);
+    int count = 0;
+    while (count < 100 || !moving.rehashing()) {
+        moving.insert(std::to_string(count++));
+    }
+    HashSet<std::string, Chaining> frozen{moving};
+    affirm(frozen.rehashing());
+    moving.insert(std::string{"alpaca"});
+    affirm(!frozen.shared());
+    frozen.insert(std::string{"vicuna"});
+    bool bothComplete = true;
+    for (int i = 0; i < count; ++i) {
+        std::string word = std::to_string(i);
+        bothComplete =
+            bothComplete && moving.exists(word) && frozen.exists(word);
+    }
+    affirm(bothComplete);
+    affirm(moving.exists("alpaca") && !moving.exists("vicuna"));
+    affirm(frozen.exists("vicuna") && !frozen.exists("alpaca"));
+
+    // ... or when turning incremental rehashing off finishes it at once
+    HashSet<int> halfway(4, 1.0);
+    halfway.incrementalRehash(true);
+    for (int i = 0; i < 5; ++i) {
+        halfway.insert(i);
+    }
+    affirm(halfway.rehashing());
+    HashSet<int> snap{halfway};
+    halfway.incrementalRehash(false);
+    affirm(!halfway.rehashing());
+    affirm(snap.rehashing());
+    bool bothHaveAll = true;
+    for (int i = 0; i < 5; ++i) {
+        bothHaveAll = bothHaveAll && halfway.exists(i) && snap.exists(i);
+    }
+    affirm(bothHaveAll);
+    affirm_expected(halfway.size(), 5);
+
+    // readers keep searching their snapshot while a writer builds the next
+    // version from it
+    HashSet<std::string, Swiss> published;
+    for (int i = 0; i < 1000; ++i) {
+        published.insert(std::to_string(i));
+    }
+    std::atomic<bool> readersOk{true};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([snapshot = published, &readersOk]() {
+            for (int round = 0; round < 20; ++round) {
+                for (int i = 0; i < 1000; ++i) {
+                    if (!snapshot.exists(std::to_string(i))
+                        || snapshot.exists(std::to_string(i + 1000))) {
+                        readersOk = false;
+                    }
+                }
+            }
+        });
+    }
+    HashSet<std::string, Swiss> next{published};
+    for (int i = 1000; i < 3000; ++i) {
+        next.insert(std::to_string(i));
+        next.erase(std::to_string(i - 1000));
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    affirm(readersOk);
+    published = next;
+    affirm_expected(published.size(), 1000);
+    affirm(published.exists("2999") && !published.exists("999"));
+
+    // Print a short summary of the all the affirmations and return true
+    // if they were all successful.
+    return log.summarize();
+}
+
+/// Returns the items of a set (or a run of its buckets) as sorted strings
+template <typename Range>
+std::vector<std::string> sortedItems(const Range& range) {
+    std::vector<std::string> items;
+    for (const auto& item : range) {
+        items.emplace_back(item);
+    }
+    std::sort(items.begin(), items.end());
+    return items;
+}
+
+/// Checks that iterating over a set, over its bucket ranges, and with
+/// parallelForEach all visit exactly the items in the set
+template <typename Set>
+bool visitsEverything(const Set& set, const std::vector<std::string>& want) {
+    bool ok = sortedItems(set) == want
+              && size_t(std::distance(set.begin(), set.end())) == set.size();
+
+    std::vector<std::string> fromRanges;
+    auto ranges = set.bucketRanges(7);
+    for (const auto& range : ranges) {
+        auto items = sortedItems(range);
+        fromRanges.insert(fromRanges.end(), items.begin(), items.end());
+    }
+    std::sort(fromRanges.begin(), fromRanges.end());
+    ok = ok && fromRanges == want && ranges.size() <= 8;
+
+    std::atomic<size_t> visited{0};
+    std::atomic<size_t> totalLength{0};
+    set.parallelForEach(
+        [&](const auto& item) {
+            ++visited;
+            totalLength += std::string_view{item}.size();
+        },
+        4);
+    size_t wantLength = 0;
+    for (const auto& item : want) {
+        wantLength += item.size();
+    }
+    return ok && visited == want.size() && totalLength == wantLength;
+}
+
+/// Fills a set of each layout, erases some items, and checks that every
+/// way of visiting the items finds exactly the rest
+template <typename Layout>
+bool iteratesOverEverything() {
+    HashSet<std::string, Layout> empty;
+    bool ok = empty.begin() == empty.end() && visitsEverything(empty, {});
+
+    HashSet<std::string, Layout> words;
+    std::vector<std::string> want;
+    for (int i = 0; i < 1000; ++i) {
+        words.insert(std::to_string(i));
+        if (i % 7 == 0) {
+            words.erase(std::to_string(i));
+        } else {
+            want.push_back(std::to_string(i));
+        }
+    }
+    std::sort(want.begin(), want.end());
+    return ok && visitsEverything(words, want);
+}
+
+bool iterationTest() {
+    // Set up the TestingLogger object, giving a suitable description
+    TestingLogger log{"28 iterators, bucket ranges and parallelForEach"};
+
+    affirm(iteratesOverEverything<Chaining>());
+    affirm(iteratesOverEverything<RobinHood>());
+    affirm(iteratesOverEverything<Swiss>());
+    affirm(iteratesOverEverything<Arena>());
+    affirm(iteratesOverEverything<Cuckoo>());
+
+    // in the middle of an incremental rehash, the old table's items are
+    // visited too
+    HashSet<std::string, Chaining> moving(16);
+    moving.incrementalRehash(true);
+    std::vector<std::string> want;
+    while (want.size() < 100 || !moving.rehashing()) {
+        want.push_back(std::to_string(want.size()));
+        moving.insert(want.back());
+    }
+    std::sort(want.begin(), want.end());
+    affirm(visitsEverything(moving, want));
+
+    // the test's int hash gives many keys equal hashes, which puts some of
+    // them in the cuckoo stash
+    HashSet<CopyCounter, Cuckoo> clumped;
+    for (int i = 0; i < 150; ++i) {
+        clumped.insert(CopyCounter{i});
+    }
+    affirm_expected(std::distance(clumped.begin(), clumped.end()), 150);
+    size_t inRanges = 0;
+    for (const auto& range : clumped.bucketRanges(5)) {
+        inRanges += std::distance(range.begin(), range.end());
+    }
+    affirm_expected(inRanges, 150);
+
+    // the usual iterator operations
+    HashSet<std::string> llamas;
+    llamas.insert(std::string{"llama"});
+    auto first = llamas.begin();
+    affirm_expected(first->size(), 5);
+    affirm(first++ == llamas.begin());
+    affirm(first == llamas.end());
+
+    // an exception in one thread stops the rest and comes out of the call
+    bool caught = false;
+    try {
+        HashSet<std::string, Swiss> words;
+        for (int i = 0; i < 1000; ++i) {
+            words.insert(std::to_string(i));
+        }
+        words.parallelForEach([](const std::string& word) {
+            if (word == "500") {
+                throw std::runtime_error{"found it"};
+            }
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    affirm(caught);
 
     // Print a short summary of the all the affirmations and return true
     // if they were all successful.
@@ -228,6 +1854,28 @@ int main() {
     printTest();
     rehashTest();
     collisionsTest();
+    robinHoodTest();
+    cachedHashTest();
+    incrementalRehashTest();
+    moveAndEmplaceTest();
+    transparentKeyTest();
+    hashPolicyTest();
+    wordHashTest();
+    swissTest();
+    bloomFilterTest();
+    dictImageTest();
+    arenaTest();
+    existsBatchTest();
+    concurrentTest();
+    wordFileTest();
+    wordStreamTest();
+    frozenHashSetTest();
+    seededHashTest();
+    cuckooTest();
+    reserveTest();
+    eraseTest();
+    snapshotTest();
+    iterationTest();
 
     if (alltests.summarize(true)) {
         return 0;  // Error code of 0 == Success!
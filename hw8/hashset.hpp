@@ -3,7 +3,21 @@
  *
  * Authors: Christian and Olivia
  *
- * Provides HashSet<T>, a set class template, using hash tables
+ * Provides HashSet<T, Layout, Hash, KeyEqual>, a set class template, using
+ * hash tables.  The Layout policy picks how elements are stored:
+ *   Chaining   one singly-linked list per bucket (the default)
+ *   RobinHood  a flat, open-addressed array using Robin Hood linear probing
+ *   Swiss      a flat array with one-byte tags, probed 16 slots at a time
+ *   Arena      (std::string only) every word's bytes in one shared arena
+ *   Cuckoo     buckets of four slots, each element in one of two buckets
+ * Hash (by default, whatever myhash overload fits) maps elements to size_t,
+ * and KeyEqual (by default, ==) compares them.  An optional Bloom filter
+ * (see useBloomFilter) lets most lookups of absent keys skip the table.
+ * With a keyed Hash policy such as SipHash, the set can also rebuild itself
+ * under a new random key when a chain gets too long (see reseedAfter).
+ * Copies are cheap: they share the table until one of them changes it.
+ * The items can be iterated over, whole or in disjoint runs of buckets
+ * (see bucketRanges), and parallelForEach visits them with many threads.
  *
  * Part of CS70 Homework 8. This file may NOT be shared with anyone other
  * than the author(s) and the current semester's CS70 staff without explicit
@@ -14,41 +28,260 @@
 #define HASHSET_HPP_INCLUDED
 
 #include <iostream>
-#include <forward_list>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include <cstddef>
+#include <cstdint>
 
-template <typename T>
+#include "chainedtable.hpp"
+#include "robinhoodtable.hpp"
+#include "swisstable.hpp"
+#include "arenatable.hpp"
+#include "cuckootable.hpp"
+#include "bloomfilter.hpp"
+
+/* \brief Layout policy: separate chaining, one linked list per bucket
+ */
+struct Chaining {
+    template <typename T>
+    using Table = ChainedTable<T>;
+};
+
+/* \brief Layout policy: open addressing in one flat array (Robin Hood
+ *        linear probing); collisions() and maximal() then count probe
+ *        distances instead of chain lengths
+ */
+struct RobinHood {
+    template <typename T>
+    using Table = RobinHoodTable<T>;
+};
+
+/* \brief Layout policy: open addressing with a Swiss-table control byte per
+ *        slot, probing 16 slots at once (with SSE2 when available);
+ *        maximal() counts groups probed, and collisions() counts inserts
+ *        that had to leave their home group
+ */
+struct Swiss {
+    template <typename T>
+    using Table = SwissTable<T>;
+};
+
+/* \brief Layout policy: for HashSet<std::string> only, keeps the strings'
+ *        bytes back to back in one arena and probes a flat array of
+ *        (hash, offset, length) slots; KeyEqual must accept a
+ *        std::string_view
+ */
+struct Arena {
+    template <typename T>
+    using Table = ArenaTable<T>;
+};
+
+/* \brief Layout policy: bucketized cuckoo hashing, where every element is
+ *        in one of two buckets of four slots, so a search never reads more
+ *        than two buckets; maximal() counts buckets read, and collisions()
+ *        counts inserts whose first bucket was full
+ */
+struct Cuckoo {
+    template <typename T>
+    using Table = CuckooTable<T>;
+};
+
+/* \brief Default hash policy: calls the myhash overload for the key, which
+ *        must be declared before this header is included (or be found by
+ *        argument-dependent lookup)
+ */
+struct MyHash {
+    using is_transparent = void;
+
+    template <typename K>
+    size_t operator()(const K& key) const {
+        return myhash(key);
+    }
+};
+
+/* \brief Says whether a Hash or KeyEqual policy accepts keys of other types
+ *        (by defining is_transparent, as std::equal_to<> does)
+ */
+template <typename F, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename F>
+struct IsTransparent<F, std::void_t<typename F::is_transparent>>
+    : std::true_type {};
+
+/* \brief Says whether a Hash policy can be given a new random key (by
+ *        defining reseed(uint64_t), as SipHash does)
+ */
+template <typename F, typename = void>
+struct IsSeedable : std::false_type {};
+
+template <typename F>
+struct IsSeedable<
+    F, std::void_t<decltype(std::declval<F&>().reseed(uint64_t{}))>>
+    : std::true_type {};
+
+/* \brief Says whether HashSet<T> may look up a key of type K directly,
+ *        without first converting it to a T.  That is only safe when the
+ *        hash gives a K the same value as the T it stands for, and K
+ *        compares equal to that T.  Strings allow string views and C
+ *        strings; specialize this template to allow other pairs.  Both the
+ *        Hash and KeyEqual policies must also be transparent.
+ */
+template <typename T, typename K>
+struct IsTransparentKey : std::false_type {};
+
+template <>
+struct IsTransparentKey<std::string, std::string_view> : std::true_type {};
+template <>
+struct IsTransparentKey<std::string, const char*> : std::true_type {};
+template <>
+struct IsTransparentKey<std::string, char*> : std::true_type {};
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+class ConcurrentHashSet;
+
+template <typename T, typename Layout = Chaining, typename Hash = MyHash,
+          typename KeyEqual = std::equal_to<>>
 class HashSet {
  public:
+    /* \brief The storage class selected by the Layout policy
+     */
+    using Table = typename Layout::template Table<T>;
+
+    /* \brief Enables an overload only for transparent key types
+     */
+    template <typename K>
+    using EnableIfTransparent =
+        std::enable_if_t<IsTransparentKey<T, std::decay_t<K>>::value
+                         && IsTransparent<Hash>::value
+                         && IsTransparent<KeyEqual>::value>;
+
+    /* \brief Enables a member only for a seedable Hash policy
+     */
+    template <typename H>
+    using EnableIfSeedable = std::enable_if_t<IsSeedable<H>::value>;
+
     /* \brief Default number of buckets, used by constructor but also
      *        accessible to client code
      */
     static constexpr size_t DEFAULT_NUM_BUCKETS = 10;
     /* \brief Default maximum load factor, used by constructor but also
-     *        accessible to client code
+     *        accessible to client code (depends on the layout)
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR =
+        Table::DEFAULT_MAX_LOAD_FACTOR;
+    /* \brief Number of old buckets moved into the new table by each insert
+     *        while an incremental rehash is in progress
+     */
+    static constexpr size_t MIGRATION_STEP = 4;
+    /* \brief Number of keys existsBatch hashes (and starts loading the
+     *        buckets for) before it finishes searching for any of them
+     */
+    static constexpr size_t BATCH_SIZE = 16;
+
+    /* \brief Forward iterator over the items, in no particular order,
+     *        giving a const T& (or, for the Arena layout, a
+     *        std::string_view); the items can't be changed through it
+     * \note Any change to the set invalidates every iterator.
+     */
+    class const_iterator {
+     public:
+        using TableIterator = typename Table::const_iterator;
+        using value_type =
+            typename std::iterator_traits<TableIterator>::value_type;
+        using reference =
+            typename std::iterator_traits<TableIterator>::reference;
+        using pointer = typename std::iterator_traits<TableIterator>::pointer;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        /* \brief Default constructor, giving an iterator that can only be
+         *        assigned to
+         */
+        const_iterator() = default;
+
+        reference operator*() const;
+        template <typename R = reference,
+                  typename = std::enable_if_t<std::is_reference_v<R>>>
+        pointer operator->() const;
+        const_iterator& operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator& other) const;
+        bool operator!=(const const_iterator& other) const;
+
+     private:
+        friend class HashSet;
+
+        /* \brief Walks from current to stop in one table, then (if next
+         *        isn't null) through all of next
+         */
+        const_iterator(TableIterator current, TableIterator stop,
+                       const Table* next);
+
+        /* \brief Moves on to the next table if this one is used up
+         */
+        void skipToNextTable();
+
+        TableIterator current_;         // position in the current table
+        TableIterator stop_;            // where the current table's run ends
+        const Table* next_ = nullptr;   // the table to go on to, if any
+    };
+    using iterator = const_iterator;
+
+    /* \brief A run of consecutive buckets of one table, for iterating over
+     *        just the items in them (in a range-based for, say)
      */
-    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 4.0;
+    class BucketRange {
+     public:
+        const_iterator begin() const;
+        const_iterator end() const;
+
+     private:
+        friend class HashSet;
+        BucketRange(const_iterator first, const_iterator last);
+
+        const_iterator first_;  // the first item in the run
+        const_iterator last_;   // just past the last item in the run
+    };
 
     /* \brief Parameterized constructor
      * \param initial number of buckets in the hash table
      * \param maximum load factor
+     * \param the hash and equality objects to use
      * This constructor is also the default constructor
      */
     explicit HashSet(size_t numBuckets = DEFAULT_NUM_BUCKETS,
-                     double maxLoadFactor = DEFAULT_MAX_LOAD_FACTOR);
+                     double maxLoadFactor = DEFAULT_MAX_LOAD_FACTOR,
+                     const Hash& hash = Hash(),
+                     const KeyEqual& equal = KeyEqual());
 
-    // Copy constructor and assignment operator are disabled.  You are
-    // allowed to implement them if you want, but you don't have to.
+    /* \brief Copy constructor: makes a snapshot of another set
+     * \note Takes Θ(1) time.  The copy shares the other set's table (and
+     *       Bloom filter) until either set is changed; the first change
+     *       copies the table, in Θ(n + m) time, for the set that made it.
+     *       So a copy can be handed to another thread and read there while
+     *       the original goes on changing, and neither sees the other's
+     *       changes.  (Each set itself must still be used by one thread at
+     *       a time, unless none is changing it.)
+     */
+    HashSet(const HashSet& other) = default;
 
-    HashSet(const HashSet<T>& other) = delete;
-    HashSet<T>& operator=(const HashSet<T>& other) = delete;
+    /* \brief Copy assignment: makes this set a snapshot of another one
+     * \note Takes Θ(1) time, as for the copy constructor.
+     */
+    HashSet& operator=(const HashSet& other) = default;
 
-    /* \brief Swaps the contents of two HashSet<T> objects
-     * \param the HashSet<T> to swap with
+    /* \brief Swaps the contents of two HashSet objects
+     * \param the HashSet to swap with
      * \note Requires Θ(1) time.
      */
-    void swap(HashSet<T>&);
+    void swap(HashSet&);
 
     /* \brief Destructor
      * \note Requires Θ(n) time, where n is the number of elements in the set.
@@ -67,6 +300,29 @@ class HashSet {
      */
     void insert(const T&);
 
+    /* \brief Inserts an item into the hash table by moving it
+     * \param the item to insert (left moved-from if it was inserted)
+     * \note Same time bounds as insert(const T&).
+     */
+    void insert(T&&);
+
+    /* \brief Constructs an item from the arguments and inserts it, unless
+     *        an equal item is already in the hash table
+     * \param the arguments for T's constructor
+     * \note Same time bounds as insert(const T&).
+     */
+    template <typename... Args>
+    void emplace(Args&&... args);
+
+    /* \brief Inserts an item given as a transparent key (see
+     *        IsTransparentKey), only building a T from it if it isn't
+     *        already in the hash table
+     * \param the key to insert
+     * \note Same time bounds as insert(const T&).
+     */
+    template <typename K, typename = EnableIfTransparent<K>>
+    void insert(const K&);
+
     /* \brief Inserts an item into the hash table w/o checking if it exists
      * \param the item to insert
      * \note Takes Θ(1) amortized expected time under the probability model
@@ -74,6 +330,20 @@ class HashSet {
      */
     void newInsert(const T&);
 
+    /* \brief Removes an item from the hash table, if it is there
+     * \param the item (or a transparent key, see IsTransparentKey) to remove
+     * \returns whether the item was there
+     * \note Takes Θ(1) amortized expected time, like insert.  If the load
+     *       factor falls below the minimum (see minLoadFactor), the table is
+     *       rebuilt half full at a smaller size, so the memory it holds
+     *       follows the number of items.  Chained and Robin Hood tables
+     *       leave nothing behind; the Swiss, Arena and Cuckoo layouts may
+     *       leave a vacated slot (or flag) until the table is next rebuilt.
+     */
+    bool erase(const T&);
+    template <typename K, typename = EnableIfTransparent<K>>
+    bool erase(const K&);
+
     /* \brief Returns whether an item is in the hash table
      * \param the item to search for
      * \note Takes Θ(1) amortized expected time under the probability model
@@ -81,6 +351,73 @@ class HashSet {
      */
     bool exists(const T&) const;
 
+    /* \brief Returns whether an item is in the hash table, given a
+     *        transparent key (see IsTransparentKey) so that no T needs to be
+     *        built, e.g., a std::string_view for a HashSet<std::string>
+     * \param the key to search for
+     * \note Same time bounds as exists(const T&).
+     */
+    template <typename K, typename = EnableIfTransparent<K>>
+    bool exists(const K&) const;
+
+    /* \brief Looks up a range of items at once, writing whether each one is
+     *        in the hash table to an output iterator
+     * \param the range of items (Ts or transparent keys) to search for,
+     *        and where to write the results (one bool per item, in order)
+     * \returns the output iterator, just past the last result written
+     * \note Same time bounds as exists(const T&) per item.  The items are
+     *       hashed BATCH_SIZE at a time and their buckets prefetched before
+     *       any of them is searched, so the cache misses of independent
+     *       lookups overlap instead of happening one after another.  The
+     *       range is read twice, so it needs forward iterators.
+     */
+    template <typename ForwardIt, typename OutputIt>
+    OutputIt existsBatch(ForwardIt first, ForwardIt last, OutputIt out) const;
+
+    /* \brief Calls a function on every item in the hash table, in no
+     *        particular order
+     * \param the function, which is given each item as a const T& (or, for
+     *        the Arena layout, as a std::string_view)
+     * \note Takes Θ(n + m) time, where m is the number of buckets.
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Returns an iterator to the first item (see const_iterator)
+     * \note Takes O(m) time, to find a bucket with an item in it.  Walking
+     *       all the way to end() takes Θ(n + m) time.
+     */
+    const_iterator begin() const;
+
+    /* \brief Returns the iterator just past the last item
+     * \note Takes Θ(1) time.
+     */
+    const_iterator end() const;
+
+    /* \brief Splits the buckets into runs that between them hold every
+     *        item once, for handing to separate threads
+     * \param the number of runs wanted (while an incremental rehash is in
+     *        progress, there may be one more, as no run spans two tables)
+     * \returns the runs, each with about the same number of buckets (and
+     *          so, for a good hash, of items)
+     * \note Takes O(m) time, to find where each run starts.
+     */
+    std::vector<BucketRange> bucketRanges(size_t count) const;
+
+    /* \brief Calls a function on every item, using several threads at once
+     * \param the function (given items as forEach gives them), and the
+     *        number of threads, where 0 means one per hardware thread
+     * \throws the first exception the function threw, if it threw any, once
+     *         every thread has stopped
+     * \note The function is called from several threads at the same time,
+     *       so it must be safe to do that, and nothing may change the set
+     *       until parallelForEach returns.  Each thread takes a few runs of
+     *       buckets (see bucketRanges) in turn, so a slow run doesn't hold
+     *       the others up.
+     */
+    template <typename F>
+    void parallelForEach(F&& fn, size_t threads = 0) const;
+
     /* \brief Prints the hash table to a stream
      * \param the stream to print to
      */
@@ -97,11 +434,122 @@ class HashSet {
      */
     double getMaxLoad();
 
+    /* \brief Sets the minimum load factor, below which erase shrinks the
+     *        table (0 means never shrink)
+     * \param the new minimum load factor; the default is a quarter of the
+     *        maximum given to the constructor
+     * \note Takes Θ(1) time.  The hash table is not rehashed by this call.
+     *       Erasing from a set sized by reserve() shrinks it as well, unless
+     *       the minimum is 0.
+     */
+    void minLoadFactor(double);
+
+    /* \brief Gets the min load factor
+     */
+    double getMinLoad() const;
+
     /* \brief Rehashes the hash table
-     * \note Takes Θ(n) time.
+     * \note Takes Θ(n) time.  Any incremental rehash in progress is
+     *       finished first.
      */
     void rehash();
 
+    /* \brief Makes room for a number of elements, so that inserting that
+     *        many causes no rehashing
+     * \param the number of elements to make room for
+     * \note Takes Θ(n + m) time if the table has to be rebuilt (which
+     *       reallocations() counts), and Θ(1) time if it is big enough
+     *       already.  A Bloom filter is resized for that many keys too.
+     */
+    void reserve(size_t);
+
+    /* \brief Rebuilds the hash table at the smallest size that holds the
+     *        current elements within the maximum load factor, if that is
+     *        smaller than it is now
+     * \note Takes Θ(n + m) time.  Any incremental rehash in progress is
+     *       finished first.
+     */
+    void shrinkToFit();
+
+    /* \brief Turns incremental rehashing on or off
+     * \param whether growing should be incremental
+     * \note When on, growing the table allocates the new bucket array but
+     *       leaves the elements where they are; each later insert then moves
+     *       MIGRATION_STEP old buckets across, so no single insert costs Θ(n).
+     *       Lookups check both tables while the move is in progress (but
+     *       don't move anything, so they stay read-only).
+     */
+    void incrementalRehash(bool);
+
+    /* \brief Turns recording of statistics by exists() and existsBatch() on
+     *        or off (it is on to begin with)
+     * \param whether searches should update maximal() and bloomRejections()
+     * \note While off, searches write nothing at all, so any number of
+     *       threads may search the set at once, provided none changes it.
+     *       Inserts always record their statistics.
+     */
+    void recordSearches(bool);
+
+    /* \brief Rebuilds the hash table under a new random key for the Hash
+     *        policy, which must be seedable (see IsSeedable)
+     * \note Takes Θ(n) time: every element is hashed again (the cached
+     *       hashes belong to the old key).  Any incremental rehash in
+     *       progress is finished along the way, and maximal() starts over.
+     */
+    template <typename H = Hash, typename = EnableIfSeedable<H>>
+    void reseed();
+
+    /* \brief Sets how many steps an insert's search may take before the set
+     *        reseeds itself (only for a seedable Hash policy)
+     * \param the most steps allowed, or 0 never to reseed (the default)
+     * \note A run that long means the hash is doing badly on these keys,
+     *       whether by bad luck or by someone's design, and under a new
+     *       random key they spread out again.  The set reseeds at most once
+     *       per quarter of its size inserted, so a limit too tight for the
+     *       load still costs only Θ(1) amortized time per insert.
+     */
+    template <typename H = Hash, typename = EnableIfSeedable<H>>
+    void reseedAfter(size_t steps);
+
+    /* \brief Returns the number of times the set has reseeded itself
+     * \note Takes Θ(1) time.
+     */
+    size_t reseeds() const;
+
+    /* \brief Returns whether an incremental rehash is in progress
+     * \note Takes Θ(1) time.
+     */
+    bool rehashing() const;
+
+    /* \brief Returns whether the set still shares its table with a copy,
+     *        so that the next change will copy the table first
+     * \note Takes Θ(1) time.
+     */
+    bool shared() const;
+
+    /* \brief Turns the Bloom-filter prefilter on or off
+     * \param the false-positive rate to aim for, or 0 to turn it off
+     * \note When on, every lookup first checks a blocked Bloom filter (one
+     *       cache line) and only searches the table if the filter says the
+     *       key might be there.  The filter is rebuilt from the cached
+     *       hashes, at twice the size, whenever the set outgrows it, so it
+     *       costs Θ(1) amortized time per insert.  Turning it on takes Θ(n)
+     *       time.
+     */
+    void useBloomFilter(double falsePositiveRate);
+
+    /* \brief Returns the false-positive rate the Bloom filter aims for, or
+     *        0 if there is no filter
+     * \note Takes Θ(1) time.
+     */
+    double bloomFalsePositiveRate() const;
+
+    /* \brief Returns the number of searches the Bloom filter answered
+     *        without looking in the table
+     * \note Takes Θ(1) time.
+     */
+    size_t bloomRejections() const;
+
     /* \brief Returns the number of buckets in the hash table
      * \note Takes Θ(1) time.
      */
@@ -113,11 +561,14 @@ class HashSet {
     double loadFactor() const;
 
     /* \brief Returns the number of times the hash table has been reallocated
+     *        (including any time the layout grew by itself, as the Cuckoo
+     *        layout does when displacing elements fails)
      * \note Takes Θ(1) time.
      */
     size_t reallocations() const;
 
     /* \brief Returns the number of collisions since the last reallocation
+     *        (inserts into an occupied bucket or home slot)
      * \note Takes Θ(1) time.
      */
     size_t collisions() const;
@@ -127,29 +578,130 @@ class HashSet {
      */
     size_t maximal() const;
 
+    /* \brief Returns the largest number of elements moved between tables by
+     *        any single insert (the cost of its share of rehashing)
+     * \note Takes Θ(1) time.
+     */
+    size_t worstInsert() const;
+
     /* \brief Prints statistics about the hash table to a stream
      * \param the stream to print to
      */
     std::ostream& showStatistics(std::ostream&) const;
 
  private:
+    // each shard of a ConcurrentHashSet is a HashSet that it searches and
+    // inserts into with hashes it has already computed
+    friend class ConcurrentHashSet<T, Layout, Hash, KeyEqual>;
+
     // Data members
-    std::forward_list<T>* buckets_;  // contains the items in the hash
-    size_t numBuckets_;              // Number of buckets
+    Hash hash_;               // Maps elements to hash values
+    KeyEqual equal_;          // Decides whether two elements are the same
+    std::shared_ptr<Table> table_;     // contains the items in the hash
+    std::shared_ptr<Table> oldTable_;  // table being drained, if rehashing
+    size_t migrated_;         // old buckets already moved into table_
+    bool incremental_;        // whether growing is incremental
     double maxLoad_;          // Maximum allowed load factor for the hash table
+    double minLoad_;          // load factor below which erase shrinks
     size_t size_;             // Size of table
     size_t numHash_;          // Number of times the table has been rehashed
     size_t collisions_;       // Number of collisions
     mutable size_t maximal_;  // maximal number of steps
+    size_t worstInsert_;      // most elements moved by a single insert
+    std::shared_ptr<BloomFilter> bloom_;  // prefilter for lookups, if any
+    mutable size_t bloomRejections_;      // searches the filter answered
+    bool recordSearches_;     // whether lookups update the statistics
+    size_t reseedSteps_;      // longest insert search allowed, 0 for any
+    size_t reseedGuard_;      // size the set must reach to reseed again
+    size_t reseeds_;          // Number of times the set has reseeded
 
     // HELPER FUNCTIONS
-    /* \brief checks if it exists when inserting
+    /* \brief Looks for a value in the table (and the old one, if rehashing)
+     *        without changing anything, not even the statistics
+     * \param the hash, the value, a counter set to the steps taken, and a
+     *        flag set if the Bloom filter answered without searching
+     */
+    template <typename K>
+    bool find(size_t hash, const K& key, size_t& steps, bool& filtered) const;
+
+    /* \brief Inserts a value with a known hash unless it is already there
+     * \param the hash, and the value (copied or moved in as given)
+     */
+    template <typename V>
+    void insertHashed(size_t hash, V&& value);
+
+    /* \brief Removes a value with a known hash, if it is there, shrinking
+     *        the table if it is now too empty
+     * \returns whether the value was there
+     */
+    template <typename K>
+    bool eraseHashed(size_t hash, const K& key);
+
+    /* \brief Rebuilds the table (and Bloom filter) at half full if the load
+     *        factor is below the minimum and that would at least halve it
+     */
+    void shrinkIfNeeded();
+
+    /* \brief Gives the set tables (and a Bloom filter) of its own if it
+     *        shares them with a copy, before it changes them
+     * \note An incremental rehash in progress is finished in the copy.
+     */
+    void unshare();
+
+    /* \brief Records a newly stored hash in the Bloom filter (if any),
+     *        rebuilding the filter if the set has outgrown it
+     */
+    void noteAdded(size_t hash);
+
+    /* \brief Replaces the Bloom filter with one sized for a number of keys,
+     *        holding every element's cached hash
+     */
+    void rebuildBloomFilter(size_t capacity, double falsePositiveRate);
+
+    /* \brief Records the statistics for one search
+     * \param the steps it took, and whether the Bloom filter answered it
+     */
+    void noteSearch(size_t steps, bool filtered) const;
+
+    /* \brief Records the statistics for one lookup, if they're wanted
+     */
+    void noteLookup(size_t steps, bool filtered) const;
+
+    /* \brief Does the bookkeeping after an insert: moves some old buckets
+     *        if rehashing, grows the table if needed, and records the cost
+     */
+    void afterInsert();
+
+    /* \brief Moves up to a number of old buckets into the new table
+     * \returns the number of elements moved
+     */
+    size_t migrate(size_t numBuckets);
+
+    /* \brief Moves every element into a new table with (about) a given
+     *        number of buckets, finishing any incremental rehash first
+     * \note Does nothing if the layout rounds the size to what it is now.
+     */
+    void rehashTo(size_t numBuckets);
+
+    /* \brief Returns the fewest buckets that hold a number of elements
+     *        within the maximum load factor
+     */
+    size_t bucketsFor(size_t numElements) const;
+
+    /* \brief Counts a reallocation if the table has more buckets than it
+     *        did before an insert (some layouts grow by themselves)
+     */
+    void noteOwnGrowth(size_t bucketsBefore);
+
+    /* \brief Rehashes if the table has grown past its load limit
+     * \returns the number of elements moved
      */
-    bool insertExists(const T& value) const;
+    size_t growIfNeeded();
 };
 
-template <typename T>
-std::ostream& operator<<(std::ostream&, const HashSet<T>&);
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+std::ostream& operator<<(std::ostream&,
+                         const HashSet<T, Layout, Hash, KeyEqual>&);
 
 #include "hashset-private.hpp"
 
@@ -1,8 +1,14 @@
 #include <cs70/stringhash.hpp>
+#include "stringhash-extra.hpp"  // before hashset.hpp, for myhash overloads
 #include "hashset.hpp"
+#include "dictimage.hpp"
+#include "frozenhashset.hpp"
+#include "wordfile.hpp"
+#include "wordstream.hpp"
 #include <iostream>
-#include <fstream>
 #include <vector>
+#include <string>
+#include <string_view>
 #include <list>
 #include <algorithm>
 #include <stdexcept>
@@ -11,6 +17,9 @@
 #include <cerrno>
 #include <chrono>
 #include <random>
+#include <thread>
+#include <memory>
+#include <utility>
 #include <cstddef>
 
 /**
@@ -22,39 +31,46 @@
 void readWords(std::vector<std::string>& words, std::string filename,
                size_t maxwords) {
     std::cerr << "Reading words from " << filename << "...";
-    try {
-        std::ifstream in;
-        in.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        in.open(filename);
-        in.exceptions(std::ifstream::badbit);
-        std::string word;
-        for (size_t i = 0; i < maxwords; ++i) {
-            in >> word;
-            if (!in.good()) {
-                break;
-            }
-            words.push_back(word);
-        }
-        std::cerr << " done!\n";
-    } catch (std::system_error& e) {
-        // The error exceptions thrown by our standard library aren't very
-        // meaningful, so we catch them and rethrow them with more information.
-        throw std::system_error(
-            std::make_error_code(std::errc(errno)),
-            "Error reading '" + filename + "' (" + e.code().message() + +")");
+    WordFile file{filename};
+    size_t count = 0;
+    for (auto word = file.begin(); word != file.end() && count < maxwords;
+         ++word, ++count) {
+        words.emplace_back(*word);
+    }
+    std::cerr << " done!\n";
+}
+
+/**
+ * \brief Fill a std::vector with views of the words in a file, without
+ *        copying any of them.
+ * \param words The vector to fill.
+ * \param file The file to read, which must outlive the views.
+ * \param filename The name of the file (to report).
+ * \param maxwords Maximum number of words to read
+ */
+void readWords(std::vector<std::string_view>& words, const WordFile& file,
+               const std::string& filename, size_t maxwords) {
+    std::cerr << "Reading words from " << filename << "...";
+    size_t count = 0;
+    for (auto word = file.begin(); word != file.end() && count < maxwords;
+         ++word, ++count) {
+        words.push_back(*word);
     }
+    std::cerr << " done!\n";
 }
 
 /**
  * \brief Fill a HashSet<std::string> using content from a vector of words.
  *        The order that the words are inserted is exactly the order in the
- *        vector.  The vector is emptied of words as part of this process.
+ *        vector.  The vector is emptied of words as part of this process,
+ *        and the words are moved (not copied) into the set.
  * \param dict The HashSet<std::string> to insert into.
  * \param words The vector from which the words will be taken.
  */
-void insertAsRead(HashSet<std::string>& dict, std::vector<std::string>& words) {
-    for (const auto& word : words) {
-        dict.insert(word);
+template <typename Set>
+void insertAsRead(Set& dict, std::vector<std::string>& words) {
+    for (auto& word : words) {
+        dict.insert(std::move(word));
     }
     words.clear();
 }
@@ -66,8 +82,8 @@ void insertAsRead(HashSet<std::string>& dict, std::vector<std::string>& words) {
  * \param dict The HashSet<std::string> to insert into.
  * \param words The vector from which the words will be taken.
  */
-void insertShuffled(HashSet<std::string>& dict,
-                    std::vector<std::string>& words) {
+template <typename Set>
+void insertShuffled(Set& dict, std::vector<std::string>& words) {
     std::random_device rdev;
     std::mt19937 prng{rdev()};  // This is only a 32-bit seed (weak!), but meh.
     std::shuffle(words.begin(), words.end(), prng);
@@ -90,25 +106,79 @@ void usage(const char* progname) {
               << "  -r, --random-order     Insert words in random order,"
                  " by shuffling the input.\n"
               << "  -b, --num-buckets      Size of the hash table to use.\n"
-              << "  -l, --load-factor      Max load factor to use.\n"
+              << "  -l, --load-factor      Max load factor to use (default "
+                 "depends on the layout).\n"
+              << "  -L, --layout           Table layout: 'chained' (default), "
+                 "'robinhood',\n"
+              << "                         'swiss', 'arena' or 'cuckoo'.\n"
+              << "  -H, --hash             Hash function: 'myhash' (default), "
+                 "'djb2',\n"
+              << "                         'jenkins', 'update', 'word', "
+                 "'siphash' (keyed\n"
+              << "                         with a random seed), or 'auto' "
+                 "to pick whichever\n"
+              << "                         suits the dictionary best.\n"
+              << "  -R, --reseed-after     With -H siphash, rehash under a "
+                 "new seed when an\n"
+              << "                         insert takes more than this many "
+                 "steps.\n"
+              << "  -x, --batch            Look words up in batches, "
+                 "prefetching each\n"
+              << "                         batch's buckets first.\n"
+              << "  -j, --threads          Also look words up with this many "
+                 "threads, and\n"
+              << "                         report the speedup.\n"
+              << "  -S, --stream           Check words a chunk at a time as "
+                 "they are read,\n"
+              << "                         in bounded memory (implied when "
+                 "the file to\n"
+              << "                         check is '-', for standard "
+                 "input).\n"
+              << "  -F, --freeze           Also freeze the dictionary into a "
+                 "minimal perfect\n"
+              << "                         hash and check the words against "
+                 "that.\n"
+              << "  -g, --grow             Start from --num-buckets and grow "
+                 "while inserting,\n"
+              << "                         instead of reserving room for "
+                 "the dictionary.\n"
+              << "  -i, --incremental      Spread rehashing across inserts "
+                 "instead of\n"
+              << "                         moving everything at once.\n"
+              << "  -B, --bloom            Check a Bloom filter with this "
+                 "false-positive\n"
+              << "                         rate (e.g., 0.01) before "
+                 "searching the table.\n"
               << "  -n, --num-dict-words   Number of words to read from the "
                  "dictionary.\n"
               << "  -m, --num-check-words  Number of words to check for "
                  "spelling.\n"
               << "  -d, --dict-file        Use a different dictionary file.\n"
               << "  -p, --print-dict       Print the dictionary after "
-                 "insertion.\n";
+                 "insertion.\n"
+              << "  --save-image FILE      Save the dictionary as an image "
+                 "file.\n"
+              << "  --load-image FILE      Check against a saved image "
+                 "instead of reading\n"
+              << "                         the dictionary (use the same "
+                 "hash function).\n";
     std::cerr << "\nDefault dictionary file: " << DICT_FILE << std::endl;
     std::cerr << "Default file to check:   " << CHECK_FILE << std::endl;
 }
+
 /**
- * \brief Main program,
+ * \brief Everything the command line can configure.
  */
-int main(int argc, const char** argv) {
-    // Defaults
+struct Options {
     enum { AS_READ, SHUFFLED } insertionOrder = AS_READ;
     size_t numBuckets = HashSet<std::string>::DEFAULT_NUM_BUCKETS;
-    double loadFactor = HashSet<std::string>::DEFAULT_MAX_LOAD_FACTOR;
+    double loadFactor = 0.0;  // 0.0 means the layout's default
+    std::string layout = "chained";
+    std::string hash = "myhash";
+    bool grow = false;  // don't reserve room for the dictionary first
+    bool incremental = false;
+    size_t reseedAfter = 0;  // 0 means never reseed
+    double bloomRate = 0.0;  // 0.0 means no Bloom filter
 
     std::string dictFile = DICT_FILE;
     std::string fileToCheck = CHECK_FILE;
@@ -118,18 +188,504 @@ int main(int argc, const char** argv) {
 
     bool printDict = false;
 
+    bool batch = false;     // look words up with existsBatch
+    size_t threads = 1;     // threads to look words up with
+    bool stream = false;    // check words chunk by chunk as they're read
+    bool freeze = false;    // also check against a FrozenHashSet copy
+
+    std::string saveImage;  // empty means don't save one
+    std::string loadImage;  // empty means build the dictionary instead
+};
+
+/**
+ * \brief Turn off (or back on) the statistics a dictionary records when it
+ *        is searched, so that several threads can search it at once.
+ * \param dict The dictionary.
+ * \param record Whether searches should record statistics.
+ */
+template <typename Dict>
+void recordSearches(Dict&, bool) {
+    // only HashSets record anything when they are searched
+}
+
+template <typename T, typename Layout, typename Hash, typename KeyEqual>
+void recordSearches(HashSet<T, Layout, Hash, KeyEqual>& dict, bool record) {
+    dict.recordSearches(record);
+}
+
+/**
+ * \brief Count how many words in a range are in the dictionary.
+ * \param dict The dictionary (a HashSet or a DictImage).
+ * \param first The first word to look up.
+ * \param last Just past the last word to look up.
+ * \param batch Whether to look the words up with existsBatch.
+ * \returns The number of words found in the dictionary.
+ */
+template <typename Dict>
+size_t countFound(const Dict& dict,
+                  std::vector<std::string_view>::const_iterator first,
+                  std::vector<std::string_view>::const_iterator last,
+                  bool batch) {
+    size_t inDict = 0;
+    if (batch) {
+        // a chunk at a time, so the results need no allocation
+        constexpr size_t CHUNK = 1024;
+        bool found[CHUNK];
+        while (first != last) {
+            size_t count = std::min(CHUNK, size_t(last - first));
+            dict.existsBatch(first, first + count, found);
+            inDict += std::count(found, found + count, true);
+            first += count;
+        }
+    } else {
+        for (; first != last; ++first) {
+            if (dict.exists(*first)) {
+                ++inDict;
+            }
+        }
+    }
+    return inDict;
+}
+
+/**
+ * \brief Count how many words are in the dictionary, splitting the words
+ *        into one chunk per thread.  Each thread keeps its own count, and
+ *        the counts are added up once every thread is done.
+ * \param dict The dictionary, which must not record statistics.
+ * \param words The words to look up.
+ * \param numThreads How many threads to use.
+ * \param batch Whether to look the words up with existsBatch.
+ * \returns The number of words found in the dictionary.
+ */
+template <typename Dict>
+size_t countFoundInParallel(const Dict& dict,
+                            const std::vector<std::string_view>& words,
+                            size_t numThreads, bool batch) {
+    // each count gets its own cache line, so the threads don't share one
+    struct alignas(64) Count {
+        size_t found = 0;
+    };
+    std::vector<Count> counts(numThreads);
+    std::vector<std::thread> threads;
+    size_t chunk = (words.size() + numThreads - 1) / numThreads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        auto first = words.begin() + std::min(t * chunk, words.size());
+        auto last = words.begin() + std::min((t + 1) * chunk, words.size());
+        threads.emplace_back([&dict, &counts, t, first, last, batch] {
+            counts[t].found = countFound(dict, first, last, batch);
+        });
+    }
+    size_t inDict = 0;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads[t].join();
+        inDict += counts[t].found;
+    }
+    return inDict;
+}
+
+/**
+ * \brief Look up the words to check a chunk at a time as they are read, so
+ *        memory use doesn't grow with the file, and report how long it all
+ *        took (reading included, since the two overlap).
+ * \param dict The dictionary (a HashSet or a DictImage).
+ * \param opts The options from the command line.
+ * \param numWords Set to the number of words read.
+ * \returns The number of words found in the dictionary.
+ */
+template <typename Dict>
+size_t streamWords(const Dict& dict, const Options& opts, size_t& numWords) {
+    std::cerr << "Streaming words from " << opts.fileToCheck
+              << " through the dictionary...";
+    auto startTime = std::chrono::high_resolution_clock::now();
+    WordStream stream{opts.fileToCheck};
+    std::vector<std::string_view> words;
+    size_t inDict = 0;
+    numWords = 0;
+    while (numWords < opts.maxCheckWords && stream.nextChunk(words)) {
+        size_t count = std::min(words.size(), opts.maxCheckWords - numWords);
+        inDict += countFound(dict, words.begin(), words.begin() + count,
+                             opts.batch);
+        numWords += count;
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> secs = endTime - startTime;
+    std::cerr << " done!\n";
+
+    // Show some stats
+
+    std::cout << " - reading and looking up took " << secs.count()
+              << " seconds (" << size_t(numWords / secs.count())
+              << " words per second" << (opts.batch ? ", batched" : "")
+              << ", streamed in " << stream.chunkSize() << "-byte chunks)\n"
+              << " - " << numWords << " words read, " << inDict
+              << " in dictionary\n";
+    return inDict;
+}
+
+/**
+ * \brief Read the words to check, look them all up, and report how long
+ *        it took.  With more than one thread, look them all up again in
+ *        parallel and report the speedup too.
+ * \param dict The dictionary (a HashSet or a DictImage).
+ * \param opts The options from the command line.
+ * \param numWords Set to the number of words read.
+ * \returns The number of words found in the dictionary.
+ */
+template <typename Dict>
+size_t checkWords(Dict& dict, const Options& opts, size_t& numWords) {
+    if (opts.stream) {
+        return streamWords(dict, opts, numWords);
+    }
+    // The words are views into the mapped file, so it stays open until
+    // we're done with them
+    WordFile file{opts.fileToCheck};
+    std::vector<std::string_view> words;
+    readWords(words, file, opts.fileToCheck, opts.maxCheckWords);
+    numWords = words.size();
+    std::cerr << "Looking up these words in the dictionary...";
+    auto startTime = std::chrono::high_resolution_clock::now();
+    size_t inDict = countFound(dict, words.begin(), words.end(), opts.batch);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> secs = endTime - startTime;
+
+    // The threads share the dictionary, so it mustn't change at all while
+    // they run, not even its statistics
+    std::chrono::duration<double> parallelSecs{0};
+    if (opts.threads > 1) {
+        recordSearches(dict, false);
+        startTime = std::chrono::high_resolution_clock::now();
+        size_t parallelInDict =
+            countFoundInParallel(dict, words, opts.threads, opts.batch);
+        endTime = std::chrono::high_resolution_clock::now();
+        parallelSecs = endTime - startTime;
+        recordSearches(dict, true);
+        if (parallelInDict != inDict) {
+            std::cerr << " (threads found " << parallelInDict << "!)";
+        }
+    }
+    std::cerr << " done!\n";
+
+    // Show some stats
+
+    const char* batched = opts.batch ? ", batched" : "";
+    std::cout << " - looking up took " << secs.count() << " seconds ("
+              << size_t(words.size() / secs.count()) << " words per second"
+              << batched << ")\n";
+    if (opts.threads > 1) {
+        std::cout << " - looking up with " << opts.threads << " threads took "
+                  << parallelSecs.count() << " seconds ("
+                  << size_t(words.size() / parallelSecs.count())
+                  << " words per second" << batched << ", "
+                  << secs.count() / parallelSecs.count() << "x speedup)\n";
+    }
+    std::cout << " - " << words.size() << " words read, " << inDict
+              << " in dictionary\n";
+    return inDict;
+}
+
+/**
+ * \brief Freeze a finished dictionary into a FrozenHashSet, report how long
+ *        that took and how compact it is, and check the words against it.
+ * \param dict The finished dictionary.
+ * \param opts The options from the command line.
+ * \tparam Hash The hash policy the dictionary uses.
+ */
+template <typename Hash, typename Set>
+void freezeAndCheck(const Set& dict, const Options& opts) {
+    std::cerr << "Freezing the dictionary...";
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<FrozenHashSet<std::string, Hash>> frozen;
+    try {
+        frozen.reset(new FrozenHashSet<std::string, Hash>{dict});
+    } catch (std::invalid_argument& e) {
+        std::cerr << " failed!\n";
+        std::cout << " - can't freeze the dictionary: " << e.what() << "\n";
+        return;
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> secs = endTime - startTime;
+    std::cerr << " done!\n";
+
+    std::cout << " - freezing took " << secs.count() << " seconds\n - "
+              << frozen->size() << " words frozen, ";
+    frozen->showStatistics(std::cout);
+    std::cout << " - with the frozen dictionary:\n";
+    size_t numWords;
+    checkWords(*frozen, opts, numWords);
+}
+
+/**
+ * \brief Build the dictionary, check the words, and report on both.
+ * \param opts The options from the command line.
+ * \tparam Set The kind of HashSet to use for the dictionary.
+ * \tparam Hash The hash policy Set uses (for saving an image).
+ */
+template <typename Set, typename Hash>
+int spellCheck(const Options& opts) {
+    // Read the dictionary into a vector
+    std::vector<std::string> words;
+    readWords(words, opts.dictFile, opts.maxDictWords);
+
+    // Create our search hash table (and time how long it all takes)
+    std::cerr << "Inserting into dictionary ";
+
+    // Initialize set to use the specified number of buckets and load factor
+    // (on the heap, so that destroying it can be timed too)
+    double loadFactor = opts.loadFactor > 0.0 ? opts.loadFactor
+                                              : Set::DEFAULT_MAX_LOAD_FACTOR;
+    auto dictHolder = std::make_unique<Set>(opts.numBuckets, loadFactor);
+    Set& dict = *dictHolder;
+    dict.incrementalRehash(opts.incremental);
+    if constexpr (IsSeedable<Hash>::value) {
+        dict.reseedAfter(opts.reseedAfter);
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    // With the size known up front, inserting never has to rehash
+    if (!opts.grow) {
+        dict.reserve(words.size());
+    }
+
+    if (opts.insertionOrder == Options::AS_READ) {
+        std::cerr << "(in order read)...";
+        insertAsRead(dict, words);
+    } else if (opts.insertionOrder == Options::SHUFFLED) {
+        std::cerr << "(in shuffled order)...";
+        insertShuffled(dict, words);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> secs = endTime - startTime;
+    std::cerr << " done!\n";
+
+    // Print some stats about the process
+
+    std::cout << " - insertion took " << secs.count() << " seconds\n"
+              << " - " << dict.size() << " words in " << dict.buckets()
+              << " buckets\n - ";
+    dict.showStatistics(std::cout);
+
+    // Print the dictionary if requested and it isn't too big, using
+    // the hashtable's << operator
+    constexpr size_t MAX_BUCKETS = 127;
+    if (opts.printDict) {
+        if (dict.buckets() > MAX_BUCKETS) {
+            std::cout << "\nHash table too large to print!\n\n";
+        } else {
+            std::cout << "\nHash table for dictionary:\n" << dict << std::endl;
+        }
+    }
+
+    // The filter is built once the dictionary is complete, so it only has
+    // to be sized once
+    if (opts.bloomRate > 0.0) {
+        startTime = std::chrono::high_resolution_clock::now();
+        dict.useBloomFilter(opts.bloomRate);
+        endTime = std::chrono::high_resolution_clock::now();
+        secs = endTime - startTime;
+        std::cout << " - building the Bloom filter took " << secs.count()
+                  << " seconds\n";
+    }
+
+    // Save the finished dictionary so later runs can skip building it
+    if (!opts.saveImage.empty()) {
+        startTime = std::chrono::high_resolution_clock::now();
+        DictImage<Hash>::save(dict, opts.saveImage);
+        endTime = std::chrono::high_resolution_clock::now();
+        secs = endTime - startTime;
+        std::cout << " - saving the image took " << secs.count()
+                  << " seconds\n";
+    }
+
+    // Read some words to check against our dictionary (and time it)
+    size_t numWords;
+    size_t inDict = checkWords(dict, opts, numWords);
+    if (opts.bloomRate > 0.0) {
+        std::cout << " - the Bloom filter answered " << dict.bloomRejections()
+                  << " of the " << numWords - inDict
+                  << " misses without searching\n";
+    }
+
+    // The frozen copy can't change, but needs no collisions or probing
+    if (opts.freeze) {
+        freezeAndCheck<Hash>(dict, opts);
+    }
+
+    startTime = std::chrono::high_resolution_clock::now();
+    dictHolder.reset();
+    endTime = std::chrono::high_resolution_clock::now();
+    secs = endTime - startTime;
+    std::cout << " - destroying the dictionary took " << secs.count()
+              << " seconds\n\n";
+
+    return 0;
+}
+
+/**
+ * \brief Map a saved dictionary image, check the words, and report on both.
+ * \param opts The options from the command line.
+ * \tparam Hash The hash policy the image was saved with.
+ */
+template <typename Hash>
+int spellCheckImage(const Options& opts) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::unique_ptr<DictImage<Hash>> dict;
+    try {
+        dict.reset(new DictImage<Hash>{opts.loadImage});
+    } catch (std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> secs = endTime - startTime;
+
+    std::cout << " - loading the image took " << secs.count() << " seconds\n"
+              << " - " << dict->size() << " words in " << dict->buckets()
+              << " buckets\n";
+
+    size_t numWords;
+    checkWords(*dict, opts, numWords);
+    std::cout << "\n";
+    return 0;
+}
+
+/**
+ * \brief Pick the HashSet layout named in the options and run the checker.
+ * \param opts The options from the command line.
+ * \tparam Hash The hash policy to use.
+ */
+template <typename Hash>
+int spellCheckWithHash(const Options& opts) {
+    if (!opts.loadImage.empty()) {
+        return spellCheckImage<Hash>(opts);
+    } else if (opts.layout == "chained") {
+        return spellCheck<HashSet<std::string, Chaining, Hash>, Hash>(opts);
+    } else if (opts.layout == "robinhood") {
+        return spellCheck<HashSet<std::string, RobinHood, Hash>, Hash>(opts);
+    } else if (opts.layout == "swiss") {
+        return spellCheck<HashSet<std::string, Swiss, Hash>, Hash>(opts);
+    } else if (opts.layout == "arena") {
+        return spellCheck<HashSet<std::string, Arena, Hash>, Hash>(opts);
+    } else if (opts.layout == "cuckoo") {
+        return spellCheck<HashSet<std::string, Cuckoo, Hash>, Hash>(opts);
+    }
+    std::cerr << "Unknown layout: " << opts.layout << std::endl;
+    return 1;
+}
+
+/**
+ * \brief A hash function -H can name, as a plain function so that it can
+ *        be tried out on the dictionary before any HashSet is built.
+ */
+struct HashChoice {
+    const char* name;
+    size_t (*function)(std::string_view);
+};
+
+constexpr HashChoice HASH_CHOICES[] = {
+    {"myhash", myhash},
+    {"djb2", gallery::djb2Hash},
+    {"jenkins", gallery::jenkinsOneAtATimeHash},
+    {"update", gallery::updateHash},
+    {"word", gallery::wordAtATimeHash}};
+
+/**
+ * \brief Try every hash function -H can name on a sample of the dictionary,
+ *        and pick the one whose lookups should be cheapest for this data.
+ *        Each is scored on how long it takes to hash a word plus how many
+ *        entries a successful search would compare (at one word per
+ *        bucket, with hash % buckets as ChainedTable uses), so a fast hash
+ *        that piles the words up loses to a slower one that spreads them.
+ * \param opts The options from the command line.
+ * \returns The name of the chosen hash function.
+ */
+std::string chooseHash(const Options& opts) {
+    constexpr size_t SAMPLE_SIZE = 50000;
+    constexpr double MIN_SECONDS = 0.01;  // time each hash at least this long
+    constexpr double PROBE_COST_NS = 10.0;  // rough cost of one comparison
+
+    // Spread the sample over the whole dictionary (which may be sorted)
+    WordFile file{opts.dictFile};
+    std::vector<std::string_view> words;
+    for (auto word = file.begin();
+         word != file.end() && words.size() < opts.maxDictWords; ++word) {
+        words.push_back(*word);
+    }
+    size_t stride = std::max(words.size() / SAMPLE_SIZE, size_t(1));
+    std::vector<std::string_view> sample;
+    for (size_t i = 0; i < words.size(); i += stride) {
+        sample.push_back(words[i]);
+    }
+    if (sample.empty()) {
+        return HASH_CHOICES[0].name;
+    }
+
+    std::cout << " - choosing a hash function from " << sample.size()
+              << " sampled words:\n";
+    std::string best;
+    double bestCost = 0.0;
+    std::vector<size_t> counts(sample.size());
+    for (const HashChoice& choice : HASH_CHOICES) {
+        size_t passes = 0;
+        size_t combined = 0;  // used below, so the hashing can't be skipped
+        std::chrono::duration<double> secs{0};
+        auto startTime = std::chrono::high_resolution_clock::now();
+        do {
+            for (std::string_view word : sample) {
+                combined += choice.function(word);
+            }
+            ++passes;
+            secs = std::chrono::high_resolution_clock::now() - startTime;
+        } while (secs.count() < MIN_SECONDS);
+        double hashNs = secs.count() * 1e9 / (double(sample.size()) * passes);
+
+        // a search for the k-th word in a bucket compares k entries
+        std::fill(counts.begin(), counts.end(), 0);
+        for (std::string_view word : sample) {
+            ++counts[choice.function(word) % counts.size()];
+        }
+        double compares = 0.0;
+        for (size_t count : counts) {
+            compares += count * (count + 1) / 2.0;
+        }
+        compares /= sample.size();
+
+        double cost = hashNs + PROBE_COST_NS * compares;
+        std::cout << "     " << choice.name << ": " << hashNs << " ns/hash, "
+                  << compares << " compares/hit, cost " << cost
+                  << (combined == 0 ? " (all zero!)" : "") << "\n";
+        if (best.empty() || cost < bestCost) {
+            best = choice.name;
+            bestCost = cost;
+        }
+    }
+    std::cout << " - chose " << best << "\n";
+    return best;
+}
+
+/**
+ * \brief Main program,
+ */
+int main(int argc, const char** argv) {
+    // Defaults
+    Options opts;
+
     // Process Options and command-line arguments
     std::list<std::string> args(argv + 1, argv + argc);
-    while (!args.empty() && args.front()[0] == '-') {
+    while (!args.empty() && args.front()[0] == '-' && args.front() != "-") {
         std::string option = args.front();
         if (option == "-f" || option == "--file-order") {
-            insertionOrder = AS_READ;
+            opts.insertionOrder = Options::AS_READ;
         } else if (option == "-r" || option == "--random-order") {
-            insertionOrder = SHUFFLED;
+            opts.insertionOrder = Options::SHUFFLED;
         } else if (option == "-b" || option == "--num-buckets" || option == "-l"
                    || option == "--load-factor" || option == "-n"
                    || option == "--num-dict-words" || option == "-m"
-                   || option == "--num-check-words") {
+                   || option == "--num-check-words" || option == "-B"
+                   || option == "--bloom" || option == "-j"
+                   || option == "--threads" || option == "-R"
+                   || option == "--reseed-after") {
             args.pop_front();
             if (args.empty()) {
                 std::cerr << option << " expects a number\n";
@@ -138,16 +694,28 @@ int main(int argc, const char** argv) {
             }
             try {
                 if (option == "-l" || option == "--load-factor") {
-                    loadFactor = std::stod(args.front());
+                    opts.loadFactor = std::stod(args.front());
+                } else if (option == "-B" || option == "--bloom") {
+                    opts.bloomRate = std::stod(args.front());
+                    if (!(opts.bloomRate > 0.0 && opts.bloomRate < 1.0)) {
+                        std::cerr << option << " expects a rate between 0 "
+                                  << "and 1\n";
+                        usage(argv[0]);
+                        return 1;
+                    }
                 } else {
                     size_t num = std::stoul(args.front());
                     if (option == "-b" || option == "--num-buckets") {
-                        numBuckets = num;
+                        opts.numBuckets = num;
                     } else if (option == "-n" || option == "--num-dict-words") {
-                        maxDictWords = num;
+                        opts.maxDictWords = num;
                     } else if (option == "-m"
                                || option == "--num-check-words") {
-                        maxCheckWords = num;
+                        opts.maxCheckWords = num;
+                    } else if (option == "-j" || option == "--threads") {
+                        opts.threads = std::max(num, size_t(1));
+                    } else if (option == "-R" || option == "--reseed-after") {
+                        opts.reseedAfter = num;
                     }
                 }
             } catch (std::invalid_argument& e) {
@@ -155,16 +723,46 @@ int main(int argc, const char** argv) {
                 usage(argv[0]);
                 return 1;
             }
-        } else if (option == "-d" || option == "--dict-file") {
+        } else if (option == "-d" || option == "--dict-file"
+                   || option == "--save-image" || option == "--load-image") {
             args.pop_front();
             if (args.empty()) {
                 std::cerr << option << " expects a filename\n";
                 usage(argv[0]);
                 return 1;
             }
-            dictFile = args.front();
+            if (option == "--save-image") {
+                opts.saveImage = args.front();
+            } else if (option == "--load-image") {
+                opts.loadImage = args.front();
+            } else {
+                opts.dictFile = args.front();
+            }
+        } else if (option == "-L" || option == "--layout" || option == "-H"
+                   || option == "--hash") {
+            args.pop_front();
+            if (args.empty()) {
+                std::cerr << option << " expects a name\n";
+                usage(argv[0]);
+                return 1;
+            }
+            if (option == "-L" || option == "--layout") {
+                opts.layout = args.front();
+            } else {
+                opts.hash = args.front();
+            }
+        } else if (option == "-g" || option == "--grow") {
+            opts.grow = true;
+        } else if (option == "-i" || option == "--incremental") {
+            opts.incremental = true;
+        } else if (option == "-x" || option == "--batch") {
+            opts.batch = true;
+        } else if (option == "-S" || option == "--stream") {
+            opts.stream = true;
+        } else if (option == "-F" || option == "--freeze") {
+            opts.freeze = true;
         } else if (option == "-p" || option == "--print-dict") {
-            printDict = true;
+            opts.printDict = true;
         } else if (option == "-h" || option == "--help") {
             usage(argv[0]);
             return 0;
@@ -176,77 +774,63 @@ int main(int argc, const char** argv) {
         args.pop_front();
     }
     if (!args.empty()) {
-        fileToCheck = args.front();
+        opts.fileToCheck = args.front();
         args.pop_front();
         if (!args.empty()) {
             std::cerr << "extra argument(s), " << args.front() << std::endl;
             return 1;
         }
     }
-
-    // Read the dictionary into a vector
-    std::vector<std::string> words;
-    readWords(words, dictFile, maxDictWords);
-
-    // Create our search hash table (and time how long it all takes)
-    std::cerr << "Inserting into dictionary ";
-
-    // Initialize set to use the specified number of buckets and load factor
-    HashSet<std::string> dict(numBuckets, loadFactor);
-
-    auto startTime = std::chrono::high_resolution_clock::now();
-
-    if (insertionOrder == AS_READ) {
-        std::cerr << "(in order read)...";
-        insertAsRead(dict, words);
-    } else if (insertionOrder == SHUFFLED) {
-        std::cerr << "(in shuffled order)...";
-        insertShuffled(dict, words);
+    if (opts.fileToCheck == "-") {
+        opts.stream = true;
     }
-
-    auto endTime = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> secs = endTime - startTime;
-    std::cerr << " done!\n";
-
-    // Print some stats about the process
-
-    std::cout << " - insertion took " << secs.count() << " seconds\n"
-              << " - " << dict.size() << " words in " << dict.buckets()
-              << " buckets\n - ";
-    dict.showStatistics(std::cout);
-
-    // Print the dictionary if requested and it isn't too big, using
-    // the hashtable's << operator
-    constexpr size_t MAX_BUCKETS = 127;
-    if (printDict) {
-        if (dict.buckets() > MAX_BUCKETS) {
-            std::cout << "\nHash table too large to print!\n\n";
-        } else {
-            std::cout << "\nHash table for dictionary:\n" << dict << std::endl;
-        }
+    if (opts.stream && opts.threads > 1) {
+        std::cerr << "Can't use --threads with --stream" << std::endl;
+        return 1;
     }
 
-    // Read some words to check against our dictionary (and time it)
-
-    readWords(words, fileToCheck, maxCheckWords);
-    std::cerr << "Looking up these words in the dictionary...";
-    size_t inDict = 0;
-    startTime = std::chrono::high_resolution_clock::now();
-    for (const auto& word : words) {
-        if (dict.exists(word)) {
-            ++inDict;
+    // The hash function is a compile-time policy, so it is chosen (if we're
+    // choosing) before any HashSet is built, and is then fixed for good
+    if (opts.hash == "auto") {
+        if (!opts.loadImage.empty()) {
+            std::cerr << "Can't choose a hash for an existing image; use the "
+                         "one it was saved with"
+                      << std::endl;
+            return 1;
         }
+        opts.hash = chooseHash(opts);
     }
 
-    endTime = std::chrono::high_resolution_clock::now();
-    secs = endTime - startTime;
-    std::cerr << " done!\n";
-
-    // Show some stats
-
-    std::cout << " - looking up took " << secs.count() << " seconds\n - ";
-    std::cout << words.size() << " words read, " << inDict
-              << " in dictionary\n\n";
+    // A keyed hash has a new random seed every run, so an image saved with
+    // one could never be searched again
+    if (opts.hash == "siphash"
+        && !(opts.saveImage.empty() && opts.loadImage.empty())) {
+        std::cerr << "Can't save or load an image with a keyed hash"
+                  << std::endl;
+        return 1;
+    }
+    if (opts.reseedAfter > 0 && opts.hash != "siphash") {
+        std::cerr << "--reseed-after needs a keyed hash (-H siphash)"
+                  << std::endl;
+        return 1;
+    }
 
-    return 0;
+    // The hash function is a compile-time policy, so it can be inlined
+    if (opts.hash == "myhash") {
+        return spellCheckWithHash<MyHash>(opts);
+    } else if (opts.hash == "djb2") {
+        return spellCheckWithHash<GalleryHash<gallery::djb2Hash>>(opts);
+    } else if (opts.hash == "jenkins") {
+        return spellCheckWithHash<GalleryHash<gallery::jenkinsOneAtATimeHash>>(
+            opts);
+    } else if (opts.hash == "update") {
+        return spellCheckWithHash<GalleryHash<gallery::updateHash>>(opts);
+    } else if (opts.hash == "word") {
+        return spellCheckWithHash<GalleryHash<gallery::wordAtATimeHash>>(opts);
+    } else if (opts.hash == "siphash") {
+        return spellCheckWithHash<SipHash>(opts);
+    }
+    std::cerr << "Unknown hash function: " << opts.hash << std::endl;
+    usage(argv[0]);
+    return 1;
 }
@@ -0,0 +1,194 @@
+/**
+ * robinhoodtable-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements RobinHoodTable<T>, the open-addressing layout for HashSet
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef ROBINHOODTABLE_HPP_INCLUDED
+#warning "Don't include this file directly. Include robinhoodtable.hpp instead."
+#endif
+
+#include <iostream>
+#include <optional>
+#include <limits>
+#include <utility>
+#include <cstddef>
+
+template <typename T>
+RobinHoodTable<T>::RobinHoodTable(size_t numBuckets)
+    : slots_{nullptr}, numSlots_{2}, shift_{0} {
+    // round up to a power of two (at least two, so the shift stays in range)
+    while (numSlots_ < numBuckets) {
+        numSlots_ *= 2;
+    }
+    size_t bits = 0;
+    while ((size_t(1) << bits) < numSlots_) {
+        ++bits;
+    }
+    shift_ = std::numeric_limits<size_t>::digits - bits;
+    slots_ = new Slot[numSlots_];
+}
+
+template <typename T>
+RobinHoodTable<T>::~RobinHoodTable() {
+    delete[] slots_;
+}
+
+template <typename T>
+void RobinHoodTable<T>::swap(RobinHoodTable<T>& other) {
+    using std::swap;
+    swap(slots_, other.slots_);
+    swap(numSlots_, other.numSlots_);
+    swap(shift_, other.shift_);
+}
+
+template <typename T>
+size_t RobinHoodTable<T>::buckets() const {
+    return numSlots_;
+}
+
+template <typename T>
+size_t RobinHoodTable<T>::home(size_t hash) const {
+    // 2^64 / golden ratio
+    constexpr size_t FIBONACCI_MULTIPLIER = size_t(0x9E3779B97F4A7C15ULL);
+    return (hash * FIBONACCI_MULTIPLIER) >> shift_;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool RobinHoodTable<T>::contains(size_t hash, const K& key,
+                                 const KeyEqual& equal, size_t& steps) const {
+    size_t pos = home(hash);
+    steps = 0;
+    // Any element placed further along than our own distance would have
+    // evicted a richer one, so the search can stop at the first slot whose
+    // element is closer to home than we would be.
+    for (size_t distance = 1; slots_[pos].distance >= distance; ++distance) {
+        ++steps;
+        // only compare the values themselves if the full hashes agree
+        if (slots_[pos].hash == hash && slots_[pos].value
+            && equal(*slots_[pos].value, key)) {
+            return true;
+        }
+        pos = (pos + 1) & (numSlots_ - 1);
+    }
+    return false;
+}
+
+template <typename T>
+void RobinHoodTable<T>::prefetch(size_t hash) const {
+    prefetchForRead(&slots_[home(hash)]);
+}
+
+template <typename T>
+template <typename... Args>
+bool RobinHoodTable<T>::emplaceNew(size_t hash, Args&&... args) {
+    size_t pos = home(hash);
+    bool collided = slots_[pos].distance != 0;
+    Slot carried{1, hash,
+                 std::optional<T>{std::in_place, std::forward<Args>(args)...}};
+    while (slots_[pos].distance != 0) {
+        // take the slot from any element that is closer to its home
+        if (slots_[pos].distance < carried.distance) {
+            std::swap(slots_[pos], carried);
+        }
+        pos = (pos + 1) & (numSlots_ - 1);
+        ++carried.distance;
+    }
+    slots_[pos] = std::move(carried);
+    return collided;
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool RobinHoodTable<T>::erase(size_t hash, const K& key,
+                              const KeyEqual& equal) {
+    size_t pos = home(hash);
+    for (size_t distance = 1;; ++distance) {
+        if (slots_[pos].distance < distance) {
+            return false;
+        }
+        if (slots_[pos].hash == hash && slots_[pos].value
+            && equal(*slots_[pos].value, key)) {
+            break;
+        }
+        pos = (pos + 1) & (numSlots_ - 1);
+    }
+    // Backward-shift deletion: pull each following element one slot closer
+    // to home, until one is already home (or the slot is unused), so the
+    // probe sequences stay unbroken without leaving a tombstone
+    size_t next = (pos + 1) & (numSlots_ - 1);
+    while (slots_[next].distance > 1) {
+        slots_[pos] = std::move(slots_[next]);
+        --slots_[pos].distance;
+        pos = next;
+        next = (pos + 1) & (numSlots_ - 1);
+    }
+    slots_[pos].distance = 0;
+    slots_[pos].value.reset();
+    return true;
+}
+
+template <typename T>
+size_t RobinHoodTable<T>::transferBucket(size_t bucket,
+                                         RobinHoodTable<T>& dest) {
+    Slot& source = slots_[bucket];
+    if (!source.value) {
+        return 0;
+    }
+    // the cached hash means we never need to call myhash again
+    dest.emplaceNew(source.hash, std::move(*source.value));
+    source.value.reset();
+    return 1;
+}
+
+template <typename T>
+template <typename F>
+void RobinHoodTable<T>::forEach(F&& fn) const {
+    for (size_t val = 0; val < numSlots_; ++val) {
+        if (slots_[val].value) {
+            fn(slots_[val].hash, *slots_[val].value);
+        }
+    }
+}
+
+template <typename T>
+typename RobinHoodTable<T>::const_iterator RobinHoodTable<T>::begin(
+    size_t slot) const {
+    return const_iterator{this, slot};
+}
+
+template <typename T>
+typename RobinHoodTable<T>::const_iterator RobinHoodTable<T>::end() const {
+    return const_iterator{this, numSlots_};
+}
+
+template <typename T>
+size_t RobinHoodTable<T>::nextUsed(size_t slot) const {
+    while (slot < numSlots_ && !slots_[slot].value) {
+        ++slot;
+    }
+    return slot;
+}
+
+template <typename T>
+const T& RobinHoodTable<T>::valueAt(size_t slot) const {
+    return *slots_[slot].value;
+}
+
+template <typename T>
+std::ostream& RobinHoodTable<T>::printToStream(std::ostream& out) const {
+    for (size_t val = 0; val < numSlots_; ++val) {
+        out << "[" << val << "]";
+        if (slots_[val].value) {
+            out << *slots_[val].value;
+        }
+        out << "\n";
+    }
+    return out;
+}
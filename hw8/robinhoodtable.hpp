@@ -0,0 +1,160 @@
+/**
+ * robinhoodtable.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides RobinHoodTable<T>, the open-addressing storage layout used by
+ * HashSet<T, RobinHood>.  Elements live directly in one flat array of slots,
+ * and linear probing keeps every element as close to its home slot as the
+ * Robin Hood rule ("rich elements give way to poor ones") allows, so most
+ * lookups touch only one or two cache lines.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef ROBINHOODTABLE_HPP_INCLUDED
+#define ROBINHOODTABLE_HPP_INCLUDED
+
+#include <iostream>
+#include <optional>
+#include <cstddef>
+
+#include "prefetch.hpp"
+#include "slotiterator.hpp"
+
+template <typename T>
+class RobinHoodTable {
+ public:
+    /* \brief Load factor used by HashSet when the client doesn't pick one
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.8;
+    /* \brief Largest load factor the layout can hold; HashSet always grows
+     *        the table before it gets completely full
+     */
+    static constexpr double MAX_LOAD_LIMIT = 0.95;
+
+    /* \brief Parameterized constructor
+     * \param requested number of slots, rounded up to a power of two
+     */
+    explicit RobinHoodTable(size_t numBuckets);
+
+    RobinHoodTable(const RobinHoodTable<T>& other) = delete;
+    RobinHoodTable<T>& operator=(const RobinHoodTable<T>& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(m) time, where m is the number of slots.
+     */
+    ~RobinHoodTable();
+
+    /* \brief Swaps the contents of two tables
+     * \note Requires Θ(1) time.
+     */
+    void swap(RobinHoodTable<T>& other);
+
+    /* \brief Returns the number of slots in the table
+     */
+    size_t buckets() const;
+
+    /* \brief Looks for a value along its probe sequence
+     * \param hash of the value, the value (a T or any key that compares
+     *        equal to one), the equality test, and a counter that is set to
+     *        the number of occupied slots examined
+     * \returns whether the value is in the table
+     */
+    template <typename K, typename KeyEqual>
+    bool contains(size_t hash, const K& key, const KeyEqual& equal,
+                  size_t& steps) const;
+
+    /* \brief Starts loading the memory a search for this hash will read
+     *        first, without waiting for it
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Adds a value known not to be in the table, constructing it in
+     *        place from the given arguments
+     * \returns whether the value's home slot was already occupied
+     * \note The table must have at least one empty slot.
+     */
+    template <typename... Args>
+    bool emplaceNew(size_t hash, Args&&... args);
+
+    /* \brief Removes a value, if it is in the table, shifting the
+     *        elements after it back a slot (so no tombstone is left behind)
+     * \param hash of the value, the value (or any key that compares equal
+     *        to one), and the equality test
+     * \returns whether the value was there
+     */
+    template <typename K, typename KeyEqual>
+    bool erase(size_t hash, const K& key, const KeyEqual& equal);
+
+    /* \brief Moves the element in one slot into another table, leaving the
+     *        slot vacated (still part of probe sequences, but holding nothing).
+     *        The element is moved, not copied.
+     * \param index of the slot and the table to move the element into
+     * \returns the number of elements moved
+     */
+    size_t transferBucket(size_t bucket, RobinHoodTable<T>& dest);
+
+    /* \brief Calls fn(hash, element) for every element in the table, with
+     *        the element's cached hash
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Prints the table one slot per line
+     */
+    std::ostream& printToStream(std::ostream& out) const;
+
+    /* \brief Forward iterator that walks through the slots in order,
+     *        giving a const T& for each element
+     */
+    using const_iterator = SlotIterator<RobinHoodTable<T>>;
+
+    /* \brief Returns an iterator to the first element in a slot at or after
+     *        the given one (so begin() is the first of them all)
+     */
+    const_iterator begin(size_t slot = 0) const;
+
+    /* \brief Returns the iterator just past the last element
+     */
+    const_iterator end() const;
+
+ private:
+    /* \brief One entry in the flat array.  distance is 0 for a slot that has
+     *        never been used, and otherwise one more than how far the slot is
+     *        from the home slot of the element placed there.  hash caches the
+     *        element's full hash value.
+     */
+    struct Slot {
+        size_t distance = 0;
+        size_t hash = 0;
+        std::optional<T> value;
+    };
+
+    /* \brief Maps a hash value to its home slot (Fibonacci hashing, so weak
+     *        low bits in the hash still spread across the table)
+     */
+    size_t home(size_t hash) const;
+
+    // the iterator finds its way around with these two
+    friend class SlotIterator<RobinHoodTable<T>>;
+
+    /* \brief Returns the first slot in use at or after the given one, or
+     *        the number of slots if there is none
+     */
+    size_t nextUsed(size_t slot) const;
+
+    /* \brief Returns the element in a slot that is in use
+     */
+    const T& valueAt(size_t slot) const;
+
+    Slot* slots_;       // the flat array of slots
+    size_t numSlots_;   // Number of slots, always a power of two
+    size_t shift_;      // how far to shift a mixed hash to index the slots
+};
+
+#include "robinhoodtable-private.hpp"
+
+#endif  // ROBINHOODTABLE_HPP_INCLUDED
@@ -0,0 +1,59 @@
+/**
+ * slotiterator-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements SlotIterator<Table>, the iterator for the flat table layouts
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef SLOTITERATOR_HPP_INCLUDED
+#warning "Don't include this file directly. Include slotiterator.hpp instead."
+#endif
+
+#include <memory>
+#include <cstddef>
+
+template <typename Table>
+SlotIterator<Table>::SlotIterator(const Table* table, size_t slot)
+    : table_{table}, slot_{table->nextUsed(slot)} {
+    // nothing else to do
+}
+
+template <typename Table>
+typename SlotIterator<Table>::reference SlotIterator<Table>::operator*()
+    const {
+    return table_->valueAt(slot_);
+}
+
+template <typename Table>
+template <typename R, typename>
+typename SlotIterator<Table>::pointer SlotIterator<Table>::operator->()
+    const {
+    return std::addressof(**this);
+}
+
+template <typename Table>
+SlotIterator<Table>& SlotIterator<Table>::operator++() {
+    slot_ = table_->nextUsed(slot_ + 1);
+    return *this;
+}
+
+template <typename Table>
+SlotIterator<Table> SlotIterator<Table>::operator++(int) {
+    SlotIterator<Table> before = *this;
+    ++*this;
+    return before;
+}
+
+template <typename Table>
+bool SlotIterator<Table>::operator==(const SlotIterator<Table>& other) const {
+    return table_ == other.table_ && slot_ == other.slot_;
+}
+
+template <typename Table>
+bool SlotIterator<Table>::operator!=(const SlotIterator<Table>& other) const {
+    return !(*this == other);
+}
@@ -0,0 +1,80 @@
+/**
+ * slotiterator.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides SlotIterator<Table>, the forward iterator shared by the flat
+ * table layouts (RobinHoodTable, SwissTable, ArenaTable and CuckooTable).
+ * It is just a table and a slot number: advancing asks the table for its
+ * next used slot, and dereferencing asks it for the element in the slot.
+ * So each table only has to say which slots are in use and what is in
+ * them, through two private members the iterator is a friend of:
+ *   size_t nextUsed(size_t slot) const   first used slot at or after slot
+ *                                        (or the end position if none)
+ *   valueAt(size_t slot) const           the element in a used slot
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef SLOTITERATOR_HPP_INCLUDED
+#define SLOTITERATOR_HPP_INCLUDED
+
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+
+template <typename Table>
+class SlotIterator {
+ public:
+    // What valueAt gives back: a const T& (or, for the Arena layout, a
+    // std::string_view made on the spot)
+    using reference = decltype(std::declval<const Table&>().valueAt(0));
+    using value_type = std::decay_t<reference>;
+    using pointer = const value_type*;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+
+    /* \brief Default constructor, giving an iterator that can only be
+     *        assigned to
+     */
+    SlotIterator() = default;
+
+    /* \brief Parameterized constructor
+     * \param the table, and the slot to start at (moved forward to the
+     *        first slot in use)
+     */
+    SlotIterator(const Table* table, size_t slot);
+
+    /* \brief Returns the element in the current slot
+     */
+    reference operator*() const;
+
+    /* \brief Gives access to the element's members (only for layouts
+     *        that store whole elements)
+     */
+    template <typename R = reference,
+              typename = std::enable_if_t<std::is_reference_v<R>>>
+    pointer operator->() const;
+
+    /* \brief Moves on to the next slot in use
+     */
+    SlotIterator& operator++();
+    SlotIterator operator++(int);
+
+    /* \brief Returns whether two iterators are at the same slot
+     */
+    bool operator==(const SlotIterator& other) const;
+    bool operator!=(const SlotIterator& other) const;
+
+ private:
+    const Table* table_ = nullptr;  // the table being walked through
+    size_t slot_ = 0;               // the current slot (or the end)
+};
+
+#include "slotiterator-private.hpp"
+
+#endif  // SLOTITERATOR_HPP_INCLUDED
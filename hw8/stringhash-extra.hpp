@@ -0,0 +1,365 @@
+/**
+ * stringhash-extra.hpp
+ * Authors: Christian Johnson and Olivia Schleifer
+ *
+ * Declares the string hashing entry points that stringhash.cpp provides
+ * beyond the ones in <cs70/stringhash.hpp>, along with the gallery of hash
+ * functions we have examined.  Include this (like the course
+ * header) before hashset.hpp so HashSet can see these overloads.
+ *
+ * Part of CS70 Homework 8. This file may NOT be
+ * shared with anyone other than the author(s) and
+ * the current semester's CS70 staff without
+ * explicit written permission from one of the
+ * CS70 instructors.
+ */
+
+#ifndef STRINGHASH_EXTRA_HPP_INCLUDED
+#define STRINGHASH_EXTRA_HPP_INCLUDED
+
+#include <cs70/stringhash.hpp>
+#include <string_view>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Hash Function Gallery
+//
+// These are the hash functions our group has examined.  They are inline so
+// that a HashSet using one through GalleryHash can inline it.
+namespace gallery {
+
+/**
+ * This function iterates over each character in the string and updates its
+ * hash value by multiplying by a prime (131) and adding a pointer to a
+ * character
+ */
+inline size_t updateHash(std::string_view str) {
+    size_t hash = 0;
+
+    for (char ch : str) {
+        hash = (hash * 131) + ch;
+        // 131 is a prime number often used in hash functions
+    }
+
+    return hash;
+}
+
+/**
+ * This function updates the hash values using a series of bitwise and
+ * arithmetic operations. The specific constants are chosen to provide good
+ * mixing properties
+ */
+inline size_t jenkinsOneAtATimeHash(std::string_view key) {
+    size_t hash = 0;
+    size_t i = 0;
+
+    while (i < key.length()) {
+        hash += key[i++];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+
+    return hash;
+}
+
+/**
+ * The djb2Hash function iterates through the input string and updates the has
+ * value using multiplication and the exclusive or (XOR) operation
+ *
+ */
+inline size_t djb2Hash(std::string_view str) {
+    size_t hash = 5381;  // Initial hash value
+
+    for (char ch : str) {
+        hash = (hash * 33) ^ static_cast<size_t>(ch);
+    }
+
+    return hash;
+}
+
+/**
+ * Helpers for wordAtATimeHash (kept in their own namespace because they
+ * aren't hash functions themselves).
+ */
+namespace wordhash {
+
+// Odd 64-bit constants with well-mixed bits (the same ones wyhash uses)
+constexpr uint64_t P0 = 0xa0761d6478bd642fULL;
+constexpr uint64_t P1 = 0xe7037ed1a0b428dbULL;
+constexpr uint64_t P2 = 0x8ebc6af09c88c6e3ULL;
+constexpr uint64_t P3 = 0x589965cc75374cc3ULL;
+
+// Keys at least this long are read in 32-byte stripes by accumulate()
+constexpr size_t LONG_KEY = 64;
+constexpr size_t STRIPE = 32;
+
+/**
+ * Multiplies two 64-bit values into 128 bits and folds the halves together
+ * with xor, so every input bit affects the whole result.
+ */
+inline uint64_t mulFold(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 Wide;
+    Wide product = Wide(a) * b;
+    return uint64_t(product) ^ uint64_t(product >> 64);
+#else
+    // schoolbook multiplication on 32-bit halves
+    uint64_t aLo = a & 0xffffffff, aHi = a >> 32;
+    uint64_t bLo = b & 0xffffffff, bHi = b >> 32;
+    uint64_t lolo = aLo * bLo, lohi = aLo * bHi;
+    uint64_t hilo = aHi * bLo, hihi = aHi * bHi;
+    uint64_t middle = (lolo >> 32) + (lohi & 0xffffffff) + hilo;
+    uint64_t lo = (middle << 32) | (lolo & 0xffffffff);
+    uint64_t hi = hihi + (lohi >> 32) + (middle >> 32);
+    return lo ^ hi;
+#endif
+}
+
+/**
+ * Read 8 or 4 bytes from any address (memcpy compiles to a single load).
+ */
+inline uint64_t read64(const char* p) {
+    uint64_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+inline uint64_t read32(const char* p) {
+    uint32_t word;
+    std::memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+/**
+ * Long-key inner loop, portable version: four 64-bit lanes, each taking one
+ * 8-byte word per stripe.  A lane adds the product of the two 32-bit halves
+ * of (word ^ key) plus its neighbour's raw word, the same shape of step as
+ * XXH3's accumulator.
+ */
+inline void accumulateScalar(const char* p, size_t stripes, uint64_t acc[4]) {
+    constexpr uint64_t KEY[4] = {P0, P1, P2, P3};
+    for (size_t s = 0; s < stripes; ++s, p += STRIPE) {
+        uint64_t words[4];
+        for (size_t lane = 0; lane < 4; ++lane) {
+            words[lane] = read64(p + 8 * lane);
+        }
+        for (size_t lane = 0; lane < 4; ++lane) {
+            uint64_t keyed = words[lane] ^ KEY[lane];
+            acc[lane] += (keyed & 0xffffffff) * (keyed >> 32);
+            acc[lane] += words[lane ^ 1];
+        }
+    }
+}
+
+/**
+ * Long-key inner loop, using SSE2 two lanes at a time when it is available
+ * (and gives exactly the same answer as accumulateScalar).
+ */
+inline void accumulate(const char* p, size_t stripes, uint64_t acc[4]) {
+#ifdef __SSE2__
+    const __m128i key01 = _mm_set_epi64x(int64_t(P1), int64_t(P0));
+    const __m128i key23 = _mm_set_epi64x(int64_t(P3), int64_t(P2));
+    __m128i acc01 = _mm_loadu_si128(reinterpret_cast<__m128i*>(acc));
+    __m128i acc23 = _mm_loadu_si128(reinterpret_cast<__m128i*>(acc + 2));
+    for (size_t s = 0; s < stripes; ++s, p += STRIPE) {
+        __m128i words01 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i words23 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+        __m128i keyed01 = _mm_xor_si128(words01, key01);
+        __m128i keyed23 = _mm_xor_si128(words23, key23);
+        // _mm_mul_epu32 multiplies the low halves of each lane, so pair each
+        // lane's low half with a copy of its high half
+        __m128i product01 = _mm_mul_epu32(
+            keyed01, _mm_shuffle_epi32(keyed01, _MM_SHUFFLE(2, 3, 0, 1)));
+        __m128i product23 = _mm_mul_epu32(
+            keyed23, _mm_shuffle_epi32(keyed23, _MM_SHUFFLE(2, 3, 0, 1)));
+        // swap the two words in each register to get each lane's neighbour
+        __m128i swapped01 = _mm_shuffle_epi32(words01, _MM_SHUFFLE(1, 0, 3, 2));
+        __m128i swapped23 = _mm_shuffle_epi32(words23, _MM_SHUFFLE(1, 0, 3, 2));
+        acc01 = _mm_add_epi64(acc01, _mm_add_epi64(product01, swapped01));
+        acc23 = _mm_add_epi64(acc23, _mm_add_epi64(product23, swapped23));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), acc01);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + 2), acc23);
+#else
+    accumulateScalar(p, stripes, acc);
+#endif
+}
+
+}  // end of namespace wordhash
+
+/**
+ * The wordAtATimeHash function reads the string eight bytes at a time and
+ * mixes each word in with a 64x64->128-bit multiply whose halves are xored
+ * together (the wyhash approach), instead of doing a little arithmetic per
+ * character.  Keys of 64 bytes or more first go through four independent
+ * lanes (SIMD when available) so the multiplies can overlap.
+ */
+inline size_t wordAtATimeHash(std::string_view str) {
+    using namespace wordhash;
+    const char* p = str.data();
+    size_t left = str.size();
+    uint64_t hash = P0 ^ (uint64_t(str.size()) * P1);
+
+    if (left >= LONG_KEY) {
+        uint64_t acc[4] = {P0, P1, P2, P3};
+        size_t stripes = left / STRIPE;
+        accumulate(p, stripes, acc);
+        p += stripes * STRIPE;
+        left -= stripes * STRIPE;
+        hash ^= mulFold(acc[0] ^ P2, acc[1] ^ P3) ^ mulFold(acc[2], acc[3]);
+    }
+
+    for (; left >= 8; p += 8, left -= 8) {
+        hash = mulFold(hash ^ read64(p), P1);
+    }
+    if (left > 0) {
+        // Gather the last 1-7 bytes into one word with fixed-size loads (the
+        // loads may overlap bytes already mixed in; the length is in the
+        // starting value, so that's harmless)
+        uint64_t tail;
+        if (str.size() >= 8) {
+            tail = read64(p + left - 8);
+        } else if (left >= 4) {
+            tail = (read32(p) << 32) | read32(p + left - 4);
+        } else {
+            tail = (uint64_t(uint8_t(p[0])) << 16)
+                   | (uint64_t(uint8_t(p[left / 2])) << 8)
+                   | uint64_t(uint8_t(p[left - 1]));
+        }
+        hash = mulFold(hash ^ tail, P2);
+    }
+    return size_t(mulFold(hash, P3 ^ str.size()));
+}
+
+}  // end of namespace gallery
+
+/**
+ * \brief Hash policy for HashSet that calls one of the gallery functions
+ *        directly (rather than through a pointer), e.g.,
+ *        HashSet<std::string, Chaining, GalleryHash<gallery::djb2Hash>>.
+ *        It hashes any string-like key, so it is transparent.
+ */
+template <size_t (*hashFunction)(std::string_view)>
+struct GalleryHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const {
+        return hashFunction(str);
+    }
+};
+
+/**
+ * SipHash-1-3 (one compression round per word, three to finish): a keyed
+ * hash whose output can't be predicted without the 128-bit key, so nobody
+ * who doesn't know the key can choose words that collide.  It reads eight
+ * bytes at a time, like wordAtATimeHash, but takes a few more rounds of
+ * add-rotate-xor per word.
+ */
+inline uint64_t sipHash13(std::string_view str, uint64_t key0, uint64_t key1) {
+    uint64_t v0 = 0x736f6d6570736575ULL ^ key0;
+    uint64_t v1 = 0x646f72616e646f6dULL ^ key1;
+    uint64_t v2 = 0x6c7967656e657261ULL ^ key0;
+    uint64_t v3 = 0x7465646279746573ULL ^ key1;
+    auto rotate = [](uint64_t x, int bits) {
+        return (x << bits) | (x >> (64 - bits));
+    };
+    auto round = [&] {
+        v0 += v1;
+        v1 = rotate(v1, 13) ^ v0;
+        v0 = rotate(v0, 32);
+        v2 += v3;
+        v3 = rotate(v3, 16) ^ v2;
+        v0 += v3;
+        v3 = rotate(v3, 21) ^ v0;
+        v2 += v1;
+        v1 = rotate(v1, 17) ^ v2;
+        v2 = rotate(v2, 32);
+    };
+
+    const char* p = str.data();
+    size_t left = str.size();
+    for (; left >= 8; p += 8, left -= 8) {
+        uint64_t word = gallery::wordhash::read64(p);
+        v3 ^= word;
+        round();
+        v0 ^= word;
+    }
+    // the last 0-7 bytes go in the low bytes of a word with the length
+    // (mod 256) in its top byte
+    uint64_t last = uint64_t(str.size()) << 56;
+    for (size_t i = 0; i < left; ++i) {
+        last |= uint64_t(uint8_t(p[i])) << (8 * i);
+    }
+    v3 ^= last;
+    round();
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    round();
+    round();
+    round();
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/**
+ * \brief Keyed hash policy: SipHash-1-3 under a key derived from a 64-bit
+ *        seed.  A default-constructed SipHash picks a random seed, so every
+ *        HashSet using it hashes differently; reseed() picks a new key
+ *        (HashSet::reseed uses it to rebuild a table whose chains got too
+ *        long).  It hashes any string-like key, so it is transparent.
+ */
+class SipHash {
+ public:
+    using is_transparent = void;
+
+    SipHash() {
+        std::random_device random;
+        reseed((uint64_t(random()) << 32) ^ random());
+    }
+
+    explicit SipHash(uint64_t seed) {
+        reseed(seed);
+    }
+
+    void reseed(uint64_t seed) {
+        using namespace gallery::wordhash;
+        // spread the seed over both halves of the key
+        key0_ = mulFold(seed ^ P0, P1);
+        key1_ = mulFold(seed ^ P2, P3);
+    }
+
+    size_t operator()(std::string_view str) const {
+        return size_t(sipHash13(str, key0_, key1_));
+    }
+
+ private:
+    uint64_t key0_;  // the 128-bit key
+    uint64_t key1_;
+};
+
+/**
+ * \brief Hashes a string view; always agrees with myhash(const std::string&)
+ *        on the same characters, so views can be used to look up strings.
+ */
+size_t myhash(std::string_view str);
+
+/**
+ * \brief Hashes a C string (without this, a const char* would convert
+ *        equally well to std::string and std::string_view).
+ */
+inline size_t myhash(const char* str) {
+    return myhash(std::string_view{str});
+}
+
+#endif  // STRINGHASH_EXTRA_HPP_INCLUDED
@@ -12,71 +12,30 @@
  */
 
 #include <cs70/stringhash.hpp>
+#include "stringhash-extra.hpp"
+#include <string_view>
 
 using std::string;
+using std::string_view;
 
 // Hash Function Gallery
 //
-// These are the hash functions our group has examined, one of them is used
-// as myhash (see later code in the file)
+// The hash functions our group has examined live in the gallery namespace
+// in stringhash-extra.hpp (so HashSet can inline them when they are used as
+// a GalleryHash policy); one of them is used as myhash (see later code in
+// the file).
 //
-// All the code below is in an anonymous namespace, so these function names
-// are hidden from other code.
+// The helper below is in an anonymous namespace, so its name is hidden from
+// other code.
 namespace {
 
 /**
- * This function iterates over each character in the string and updates its
- * hash value by multiplying by a prime (131) and adding a pointer to a
- * character
+ * The gallery functions work on string views (so they can hash slices of a
+ * buffer); this adapts one to the std::string signature hashInfo expects.
  */
-size_t updateHash(const std::string& str) {
-    const char* c_str = str.c_str();
-    size_t hash = 0;
-
-    while (*c_str) {
-        hash = (hash * 131) + *c_str;
-        // 131 is a prime number often used in hash functions
-        ++c_str;
-    }
-
-    return hash;
-}
-
-/**
- * This function updates the hash values using a series of bitwise and
- * arithmetic operations. The specific constants are chosen to provide good
- * mixing properties
- */
-size_t jenkinsOneAtATimeHash(const std::string& key) {
-    size_t hash = 0;
-    size_t i = 0;
-
-    while (i < key.length()) {
-        hash += key[i++];
-        hash += (hash << 10);
-        hash ^= (hash >> 6);
-    }
-
-    hash += (hash << 3);
-    hash ^= (hash >> 11);
-    hash += (hash << 15);
-
-    return hash;
-}
-
-/**
- * The djb2Hash function iterates through the input string and updates the has
- * value using multiplication and the exclusive or (XOR) operation
- *
- */
-size_t djb2Hash(const std::string& str) {
-    size_t hash = 5381;  // Initial hash value
-
-    for (char ch : str) {
-        hash = (hash * 33) ^ static_cast<size_t>(ch);
-    }
-
-    return hash;
+template <size_t (*hashFunction)(string_view)>
+size_t forString(const string& str) {
+    return hashFunction(str);
 }
 
 }  // end of anonymous namespace
@@ -93,12 +52,20 @@ size_t djb2Hash(const std::string& str) {
  * The djb2Hash function iterates through the input string and updates the has
  * value using multiplication and the exclusive or (XOR) operation
  *
+ * The wordAtATimeHash function consumes eight bytes per step, mixing each
+ * word in with a 64x64->128-bit multiply (wyhash-style), and switches to
+ * four SIMD-friendly lanes for long keys
+ *
+ * myhash uses djb2Hash; it used to call the other two functions as well
+ * and throw their results away, which tripled the cost of every hash.
  */
 
+size_t myhash(string_view str) {
+    return gallery::djb2Hash(str);
+}
+
 size_t myhash(const string& str) {
-    updateHash(str);
-    jenkinsOneAtATimeHash(str);
-    return djb2Hash(str);
+    return myhash(string_view{str});
 }
 
 // You don't have to fully understand this code, but it is used to provide a
@@ -107,7 +74,8 @@ size_t myhash(const string& str) {
 // above.
 // TODO(Students): Update this block with the names of your hash functions
 std::initializer_list<HashFunctionInfo> hashInfo = {
-    {"Update", updateHash},
-    {"Jenkins One At A Time", jenkinsOneAtATimeHash},
-    {"DJB2", djb2Hash}  // No comma for last one
+    {"Update", forString<gallery::updateHash>},
+    {"Jenkins One At A Time", forString<gallery::jenkinsOneAtATimeHash>},
+    {"DJB2", forString<gallery::djb2Hash>},
+    {"Word At A Time", forString<gallery::wordAtATimeHash>}  // No comma
 };
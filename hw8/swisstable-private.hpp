@@ -0,0 +1,304 @@
+/**
+ * swisstable-private.hpp
+ * Authors: Christian and Olivia
+ *
+ * Implements SwissTable<T>, the control-byte layout for HashSet
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef SWISSTABLE_HPP_INCLUDED
+#warning "Don't include this file directly. Include swisstable.hpp instead."
+#endif
+
+#include <iostream>
+#include <new>
+#include <limits>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* \brief Returns the index of the lowest set bit (mask must be nonzero)
+ */
+inline size_t lowestBit(uint32_t mask) {
+#ifdef __GNUC__
+    return __builtin_ctz(mask);
+#else
+    size_t bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+template <typename T>
+T& SwissTable<T>::Slot::value() {
+    return *std::launder(reinterpret_cast<T*>(storage));
+}
+
+template <typename T>
+const T& SwissTable<T>::Slot::value() const {
+    return *std::launder(reinterpret_cast<const T*>(storage));
+}
+
+template <typename T>
+SwissTable<T>::SwissTable(size_t numBuckets)
+    : tags_{nullptr},
+      slots_{nullptr},
+      numGroups_{1},
+      groupBits_{0},
+      size_{0},
+      vacated_{0} {
+    while (numGroups_ * GROUP_SIZE < numBuckets) {
+        numGroups_ *= 2;
+        ++groupBits_;
+    }
+    tags_ = new int8_t[buckets()];
+    std::memset(tags_, EMPTY, buckets());
+    slots_ = new Slot[buckets()];
+}
+
+template <typename T>
+SwissTable<T>::~SwissTable() {
+    // only full slots hold an element to destroy
+    for (size_t i = 0; i < buckets(); ++i) {
+        if (tags_[i] >= 0) {
+            slots_[i].value().~T();
+        }
+    }
+    delete[] slots_;
+    delete[] tags_;
+}
+
+template <typename T>
+void SwissTable<T>::swap(SwissTable<T>& other) {
+    using std::swap;
+    swap(tags_, other.tags_);
+    swap(slots_, other.slots_);
+    swap(numGroups_, other.numGroups_);
+    swap(groupBits_, other.groupBits_);
+    swap(size_, other.size_);
+    swap(vacated_, other.vacated_);
+}
+
+template <typename T>
+size_t SwissTable<T>::buckets() const {
+    return numGroups_ * GROUP_SIZE;
+}
+
+template <typename T>
+uint32_t SwissTable<T>::matchTag(const int8_t* tags, int8_t tag) {
+#ifdef __SSE2__
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GROUP_SIZE; ++i) {
+        mask |= uint32_t(tags[i] == tag) << i;
+    }
+    return mask;
+#endif
+}
+
+template <typename T>
+size_t SwissTable<T>::homeGroup(size_t hash) const {
+    // 2^64 / golden ratio; the group comes from the bits just below the tag
+    constexpr size_t FIBONACCI_MULTIPLIER = size_t(0x9E3779B97F4A7C15ULL);
+    constexpr size_t TAG_SHIFT = std::numeric_limits<size_t>::digits - 7;
+    return ((hash * FIBONACCI_MULTIPLIER) >> (TAG_SHIFT - groupBits_))
+           & (numGroups_ - 1);
+}
+
+template <typename T>
+int8_t SwissTable<T>::tagOf(size_t hash) {
+    constexpr size_t FIBONACCI_MULTIPLIER = size_t(0x9E3779B97F4A7C15ULL);
+    constexpr size_t TAG_SHIFT = std::numeric_limits<size_t>::digits - 7;
+    return int8_t((hash * FIBONACCI_MULTIPLIER) >> TAG_SHIFT);
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool SwissTable<T>::contains(size_t hash, const K& key, const KeyEqual& equal,
+                             size_t& steps) const {
+    int8_t tag = tagOf(hash);
+    size_t group = homeGroup(hash);
+    steps = 0;
+    // triangular probing visits every group when there are 2^k of them (an
+    // old table being drained by an incremental rehash can be entirely full,
+    // so we stop once they've all been seen)
+    for (size_t jump = 1; jump <= numGroups_; ++jump) {
+        ++steps;
+        const int8_t* tags = tags_ + group * GROUP_SIZE;
+        for (uint32_t match = matchTag(tags, tag); match != 0;
+             match &= match - 1) {
+            const Slot& slot = slots_[group * GROUP_SIZE + lowestBit(match)];
+            if (slot.hash == hash && equal(slot.value(), key)) {
+                return true;
+            }
+        }
+        // an empty slot means the value was never pushed past this group
+        if (matchTag(tags, EMPTY) != 0) {
+            return false;
+        }
+        group = (group + jump) & (numGroups_ - 1);
+    }
+    return false;
+}
+
+template <typename T>
+void SwissTable<T>::prefetch(size_t hash) const {
+    // the tags decide which slots are read, but the first match is usually
+    // in the home group
+    size_t group = homeGroup(hash);
+    prefetchForRead(tags_ + group * GROUP_SIZE);
+    prefetchForRead(&slots_[group * GROUP_SIZE]);
+}
+
+template <typename T>
+template <typename... Args>
+bool SwissTable<T>::emplaceNew(size_t hash, Args&&... args) {
+    // Vacated tags keep searches going past full groups, and only a
+    // rebuild clears them.  Like abseil, count them against the load the
+    // table is built for, and once that is used up, clear them out (each
+    // rebuild removes at least buckets() / VACATED_DIVISOR of them, so its
+    // cost is spread over that many erases).
+    if (size_ + vacated_ + 1 > buckets() * DEFAULT_MAX_LOAD_FACTOR
+        && vacated_ >= buckets() / VACATED_DIVISOR) {
+        rebuild();
+    }
+    size_t home = homeGroup(hash);
+    size_t group = home;
+    for (size_t jump = 1;; ++jump) {
+        const int8_t* tags = tags_ + group * GROUP_SIZE;
+        // new elements can go in empty or vacated slots
+        uint32_t free = matchTag(tags, EMPTY) | matchTag(tags, VACATED);
+        if (free != 0) {
+            size_t pos = group * GROUP_SIZE + lowestBit(free);
+            slots_[pos].hash = hash;
+            new (slots_[pos].storage) T(std::forward<Args>(args)...);
+            if (tags_[pos] == VACATED) {
+                --vacated_;
+            }
+            tags_[pos] = tagOf(hash);
+            ++size_;
+            return group != home;
+        }
+        group = (group + jump) & (numGroups_ - 1);
+    }
+}
+
+template <typename T>
+template <typename K, typename KeyEqual>
+bool SwissTable<T>::erase(size_t hash, const K& key, const KeyEqual& equal) {
+    int8_t tag = tagOf(hash);
+    size_t group = homeGroup(hash);
+    for (size_t jump = 1; jump <= numGroups_; ++jump) {
+        int8_t* tags = tags_ + group * GROUP_SIZE;
+        for (uint32_t match = matchTag(tags, tag); match != 0;
+             match &= match - 1) {
+            size_t pos = group * GROUP_SIZE + lowestBit(match);
+            if (slots_[pos].hash == hash && equal(slots_[pos].value(), key)) {
+                slots_[pos].value().~T();
+                // searches stop at a group with an empty slot, so if this
+                // group has one, none has ever gone past it and the slot
+                // can be empty again; otherwise it must stay in the way
+                if (matchTag(tags, EMPTY) != 0) {
+                    tags_[pos] = EMPTY;
+                } else {
+                    tags_[pos] = VACATED;
+                    ++vacated_;
+                }
+                --size_;
+                return true;
+            }
+        }
+        if (matchTag(tags, EMPTY) != 0) {
+            return false;
+        }
+        group = (group + jump) & (numGroups_ - 1);
+    }
+    return false;
+}
+
+template <typename T>
+size_t SwissTable<T>::transferBucket(size_t bucket, SwissTable<T>& dest) {
+    if (tags_[bucket] < 0) {
+        return 0;
+    }
+    Slot& source = slots_[bucket];
+    // the cached hash means we never need to call myhash again
+    dest.emplaceNew(source.hash, std::move(source.value()));
+    source.value().~T();
+    tags_[bucket] = VACATED;
+    --size_;
+    ++vacated_;
+    return 1;
+}
+
+template <typename T>
+void SwissTable<T>::rebuild() {
+    SwissTable<T> fresh{buckets()};
+    for (size_t pos = 0; pos < buckets(); ++pos) {
+        if (tags_[pos] >= 0) {
+            fresh.emplaceNew(slots_[pos].hash, std::move(slots_[pos].value()));
+            slots_[pos].value().~T();
+            tags_[pos] = EMPTY;
+        }
+    }
+    swap(fresh);
+}
+
+template <typename T>
+template <typename F>
+void SwissTable<T>::forEach(F&& fn) const {
+    for (size_t val = 0; val < buckets(); ++val) {
+        if (tags_[val] >= 0) {
+            fn(slots_[val].hash, slots_[val].value());
+        }
+    }
+}
+
+template <typename T>
+typename SwissTable<T>::const_iterator SwissTable<T>::begin(size_t slot) const {
+    return const_iterator{this, slot};
+}
+
+template <typename T>
+typename SwissTable<T>::const_iterator SwissTable<T>::end() const {
+    return const_iterator{this, buckets()};
+}
+
+template <typename T>
+size_t SwissTable<T>::nextUsed(size_t slot) const {
+    // a negative tag is an empty or vacated slot
+    while (slot < buckets() && tags_[slot] < 0) {
+        ++slot;
+    }
+    return slot;
+}
+
+template <typename T>
+const T& SwissTable<T>::valueAt(size_t slot) const {
+    return slots_[slot].value();
+}
+
+template <typename T>
+std::ostream& SwissTable<T>::printToStream(std::ostream& out) const {
+    for (size_t val = 0; val < buckets(); ++val) {
+        out << "[" << val << "]";
+        if (tags_[val] >= 0) {
+            out << slots_[val].value();
+        }
+        out << "\n";
+    }
+    return out;
+}
@@ -0,0 +1,192 @@
+/**
+ * swisstable.hpp
+ *
+ * Authors: Christian and Olivia
+ *
+ * Provides SwissTable<T>, the "Swiss table" storage layout used by
+ * HashSet<T, Swiss>.  Alongside the flat array of slots is an array of
+ * one-byte control tags: each tag says a slot is empty, vacated, or full,
+ * and for full slots holds 7 bits of the element's hash.  Slots are probed
+ * a group of 16 at a time; with SSE2 one compare-and-movemask finds every
+ * tag in the group that matches, so elements are only compared when their
+ * tags match (which is rare when the key isn't there at all).  Without SSE2
+ * a portable loop over the group's tags does the same job.
+ *
+ * Part of CS70 Homework 8. This file may NOT be shared with anyone other
+ * than the author(s) and the current semester's CS70 staff without explicit
+ * written permission from one of the CS70 instructors.
+ */
+
+#ifndef SWISSTABLE_HPP_INCLUDED
+#define SWISSTABLE_HPP_INCLUDED
+
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+
+#include "prefetch.hpp"
+#include "slotiterator.hpp"
+
+template <typename T>
+class SwissTable {
+ public:
+    /* \brief Load factor used by HashSet when the client doesn't pick one
+     */
+    static constexpr double DEFAULT_MAX_LOAD_FACTOR = 0.875;
+    /* \brief Largest load factor the layout can hold; every probe sequence
+     *        must end at an empty tag, so the table never fills up
+     */
+    static constexpr double MAX_LOAD_LIMIT = 0.9375;
+    /* \brief Number of slots probed together
+     */
+    static constexpr size_t GROUP_SIZE = 16;
+    /* \brief Once the elements and vacated slots between them fill the
+     *        default load, an insert rebuilds the table in place if at least
+     *        1/VACATED_DIVISOR of the slots are vacated (as abseil counts
+     *        them against the growth budget)
+     */
+    static constexpr size_t VACATED_DIVISOR = 32;
+
+    /* \brief Parameterized constructor
+     * \param requested number of slots, rounded up to a power-of-two number
+     *        of groups
+     */
+    explicit SwissTable(size_t numBuckets);
+
+    SwissTable(const SwissTable<T>& other) = delete;
+    SwissTable<T>& operator=(const SwissTable<T>& other) = delete;
+
+    /* \brief Destructor
+     * \note Requires Θ(m) time, where m is the number of slots.
+     */
+    ~SwissTable();
+
+    /* \brief Swaps the contents of two tables
+     * \note Requires Θ(1) time.
+     */
+    void swap(SwissTable<T>& other);
+
+    /* \brief Returns the number of slots in the table
+     */
+    size_t buckets() const;
+
+    /* \brief Looks for a value, one group of slots at a time
+     * \param hash of the value, the value (a T or any key that compares
+     *        equal to one), the equality test, and a counter that is set to
+     *        the number of groups examined
+     * \returns whether the value is in the table
+     */
+    template <typename K, typename KeyEqual>
+    bool contains(size_t hash, const K& key, const KeyEqual& equal,
+                  size_t& steps) const;
+
+    /* \brief Starts loading the memory a search for this hash will read
+     *        first, without waiting for it
+     */
+    void prefetch(size_t hash) const;
+
+    /* \brief Adds a value known not to be in the table, constructing it in
+     *        place from the given arguments
+     * \returns whether the value had to go past its home group
+     * \note The table must have at least one empty slot.  If erases have
+     *       left too many vacated slots (see VACATED_DIVISOR), the table is
+     *       rebuilt at the same size first, in Θ(m) amortized-away time.
+     */
+    template <typename... Args>
+    bool emplaceNew(size_t hash, Args&&... args);
+
+    /* \brief Removes a value, if it is in the table, leaving its slot
+     *        vacated (or empty, when no search can have gone past its group)
+     * \param hash of the value, the value (or any key that compares equal
+     *        to one), and the equality test
+     * \returns whether the value was there
+     */
+    template <typename K, typename KeyEqual>
+    bool erase(size_t hash, const K& key, const KeyEqual& equal);
+
+    /* \brief Moves the element in one slot into another table, leaving the
+     *        slot vacated (probes continue past it).  The element is moved,
+     *        not copied.
+     * \param index of the slot and the table to move the element into
+     * \returns the number of elements moved
+     */
+    size_t transferBucket(size_t bucket, SwissTable<T>& dest);
+
+    /* \brief Calls fn(hash, element) for every element in the table, with
+     *        the element's cached hash
+     */
+    template <typename F>
+    void forEach(F&& fn) const;
+
+    /* \brief Prints the table one slot per line
+     */
+    std::ostream& printToStream(std::ostream& out) const;
+
+    /* \brief Forward iterator that walks through the slots in order,
+     *        giving a const T& for each element
+     */
+    using const_iterator = SlotIterator<SwissTable<T>>;
+
+    /* \brief Returns an iterator to the first element in a slot at or after
+     *        the given one (so begin() is the first of them all)
+     */
+    const_iterator begin(size_t slot = 0) const;
+
+    /* \brief Returns the iterator just past the last element
+     */
+    const_iterator end() const;
+
+ private:
+    // Control tags; full slots hold 7 hash bits (0 to 127) instead
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t VACATED = -2;
+
+    /* \brief Storage for one element and its cached hash; the element only
+     *        exists when the slot's control tag says the slot is full
+     */
+    struct Slot {
+        size_t hash;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T& value();
+        const T& value() const;
+    };
+
+    /* \brief Returns a bitmask with bit i set if tag i of the group at
+     *        tags is equal to tag
+     */
+    static uint32_t matchTag(const int8_t* tags, int8_t tag);
+
+    /* \brief Splits a hash into its home group and 7-bit tag
+     */
+    size_t homeGroup(size_t hash) const;
+    static int8_t tagOf(size_t hash);
+
+    /* \brief Rebuilds the table at the same size, moving every element into
+     *        fresh slots so that no vacated tags are left
+     */
+    void rebuild();
+
+    // the iterator finds its way around with these two
+    friend class SlotIterator<SwissTable<T>>;
+
+    /* \brief Returns the first slot in use at or after the given one, or
+     *        the number of slots if there is none
+     */
+    size_t nextUsed(size_t slot) const;
+
+    /* \brief Returns the element in a slot that is in use
+     */
+    const T& valueAt(size_t slot) const;
+
+    int8_t* tags_;       // one control tag per slot
+    Slot* slots_;        // the flat array of slots
+    size_t numGroups_;   // Number of groups, always a power of two
+    size_t groupBits_;   // log2(numGroups_)
+    size_t size_;        // Number of full slots
+    size_t vacated_;     // Number of vacated slots
+};
+
+#include "swisstable-private.hpp"
+
+#endif  // SWISSTABLE_HPP_INCLUDED